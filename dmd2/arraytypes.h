@@ -74,4 +74,8 @@ typedef ArrayBase<struct block> Blocks;
 
 typedef ArrayBase<struct Symbol> Symbols;
 
+#if IN_LLVM
+typedef ArrayBase<struct FuncParam> FuncParams;
+#endif
+
 #endif
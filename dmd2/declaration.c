@@ -714,6 +714,8 @@ VarDeclaration::VarDeclaration(Loc loc, Type *type, Identifier *id, Initializer
 
     nakedUse = false;
 
+    escapingRefs = 0;
+
     availableExternally = true; // assume this unless proven otherwise
 #endif
 }
@@ -273,6 +273,18 @@ struct AliasDeclaration : Declaration
 
 /**************************************************************/
 
+#if IN_LLVM
+// The i'th parameter of a function a delegate is passed to, for the
+// escape analysis of closures.
+struct FuncParam
+{
+    FuncDeclaration *fd;
+    size_t index;
+
+    FuncParam(FuncDeclaration *fd, size_t index) : fd(fd), index(index) { }
+};
+#endif
+
 struct VarDeclaration : Declaration
 {
     Initializer *init;
@@ -360,6 +372,12 @@ struct VarDeclaration : Declaration
     /// This var is used by a naked function.
     bool nakedUse;
 
+    /// For delegate parameters: the number of references to the parameter
+    /// that may let the delegate escape, and the parameters of other
+    /// functions it is passed to, see FuncDeclaration::delegateParamEscapes().
+    int escapingRefs;
+    FuncParams passedTo;
+
     // debug description
     llvm::DIVariable debugVariable;
     llvm::DISubprogram debugFunc;
@@ -905,6 +923,13 @@ struct FuncDeclaration : Declaration
     
     // true if has inline assembler
     bool inlineAsm;
+
+    // parameters of other functions that this function is passed to as a
+    // delegate, instead of counting in tookAddressOf
+    FuncParams passedTo;
+
+    // returns true if a delegate passed as the i'th parameter may escape
+    int delegateParamEscapes(size_t i, FuncParams *visiting);
 #endif
 };
 
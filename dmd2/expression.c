@@ -817,6 +817,20 @@ Expression *callCpCtor(Loc loc, Scope *sc, Expression *e, int noscope)
 }
 #endif
 
+#if IN_LLVM
+/****************************************
+ * Returns true if v is a parameter holding a delegate, whose escape
+ * is tracked in v->escapingRefs.
+ */
+
+static bool isDelegateParam(VarDeclaration *v)
+{
+    return (v->storage_class & STCparameter) &&
+        !(v->storage_class & (STCref | STCout | STClazy)) &&
+        v->type && v->type->toBasetype()->ty == Tdelegate;
+}
+#endif
+
 /****************************************
  * Now that we know the exact type of the function we're calling,
  * the arguments[] need to be adjusted:
@@ -1169,7 +1183,50 @@ Type *functionParameters(Loc loc, Scope *sc, TypeFunction *tf,
                         }
                     }
                 }
+#if IN_LLVM
+                else if (a->op == TOKvar)
+                {   VarDeclaration *v = ((VarExp *)a)->var->isVarDeclaration();
+                    if (v && isDelegateParam(v))
+                        v->escapingRefs--;
+                }
+#endif
+            }
+#if IN_LLVM
+            /* Otherwise, if the body of the called function is known, whether
+             * it lets the delegate escape is inferred from it once all
+             * functions have been analyzed, see FuncDeclaration::needsClosure().
+             */
+            else if (fd && fd->fbody && (!fd->isVirtual() || fd->isFinal()))
+            {
+                Expression *a = arg;
+                if (a->op == TOKcast)
+                    a = ((CastExp *)a)->e1;
+
+                if (a->op == TOKfunction)
+                {   FuncExp *fe = (FuncExp *)a;
+                    fe->fd->tookAddressOf = 0;
+                    fe->fd->passedTo.push(new FuncParam(fd, i));
+                }
+                else if (a->op == TOKdelegate)
+                {   DelegateExp *de = (DelegateExp *)a;
+                    if (de->e1->op == TOKvar)
+                    {   VarExp *ve = (VarExp *)de->e1;
+                        FuncDeclaration *f = ve->var->isFuncDeclaration();
+                        if (f)
+                        {   f->tookAddressOf--;
+                            f->passedTo.push(new FuncParam(fd, i));
+                        }
+                    }
+                }
+                else if (a->op == TOKvar)
+                {   VarDeclaration *v = ((VarExp *)a)->var->isVarDeclaration();
+                    if (v && isDelegateParam(v))
+                    {   v->escapingRefs--;
+                        v->passedTo.push(new FuncParam(fd, i));
+                    }
+                }
             }
+#endif
 #endif
         }
         else
@@ -3885,6 +3942,7 @@ AssocArrayLiteralExp::AssocArrayLiteralExp(Loc loc,
     this->keys = keys;
     this->values = values;
     this->ownedByCtfe = false;
+    this->ctfeIndex = NULL;
 }
 
 Expression *AssocArrayLiteralExp::syntaxCopy()
@@ -4965,6 +5023,14 @@ Expression *VarExp::semantic(Scope *sc)
         v->checkNestedReference(sc, loc);
 #if DMDV2
         checkPurity(sc, v, NULL);
+#endif
+#if IN_LLVM
+        /* Any reference to a delegate parameter may let it escape, unless
+         * it turns out to be a call through it or to be passed on to a
+         * parameter that doesn't escape, see functionParameters().
+         */
+        if (isDelegateParam(v))
+            v->escapingRefs++;
 #endif
     }
     FuncDeclaration *f = var->isFuncDeclaration();
@@ -6411,6 +6477,11 @@ Expression *FileExp::semantic(Scope *sc)
 
     if (global.params.verbose)
         printf("file      %s\t(%s)\n", (char *)se->string, name);
+#if IN_LLVM
+    // the object cache has to know which files a module depends on
+    if (sc->module)
+        sc->module->stringImports.push(name);
+#endif
 
     {   File f(name);
         if (f.read())
@@ -8162,6 +8233,14 @@ Lagain:
             assert(td->next->ty == Tfunction);
             tf = (TypeFunction *)(td->next);
             p = "delegate";
+#if IN_LLVM
+            // Calling a delegate parameter doesn't let it escape
+            if (e1->op == TOKvar)
+            {   VarDeclaration *v = ((VarExp *)e1)->var->isVarDeclaration();
+                if (v && isDelegateParam(v))
+                    v->escapingRefs--;
+            }
+#endif
         }
         else if (t1->ty == Tpointer && ((TypePointer *)t1)->next->ty == Tfunction)
         {
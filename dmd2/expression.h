@@ -525,6 +525,7 @@ struct AssocArrayLiteralExp : Expression
     Expressions *keys;
     Expressions *values;
     bool ownedByCtfe;   // true = created in CTFE
+    struct CtfeAAIndex *ctfeIndex; // CTFE: hash index of keys[], see interpret.c
 
     AssocArrayLiteralExp(Loc loc, Expressions *keys, Expressions *values);
 
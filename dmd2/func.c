@@ -98,6 +98,7 @@ FuncDeclaration::FuncDeclaration(Loc loc, Loc endloc, Identifier *id, StorageCla
     // LDC
     isArrayOp = false;
     allowInlining = false;
+    inlineAsm = false;
     availableExternally = true; // assume this unless proven otherwise
 
     // function types in ldc don't merge if the context parameter differs
@@ -3195,6 +3196,61 @@ void FuncDeclaration::checkNestedReference(Scope *sc, Loc loc)
     }
 }
 
+#if IN_LLVM
+/*******************************
+ * Determine if any of the function parameters a delegate is passed to
+ * may let it escape.
+ */
+
+static int passedToEscaping(FuncParams *passedTo, FuncParams *visiting)
+{
+    for (size_t i = 0; i < passedTo->dim; i++)
+    {   FuncParam *fp = (*passedTo)[i];
+        if (fp->fd->delegateParamEscapes(fp->index, visiting))
+            return 1;
+    }
+    return 0;
+}
+
+/*******************************
+ * Determine if a delegate passed as the i'th parameter of this function
+ * may escape it. It doesn't if the body of the function only calls it,
+ * or passes it on to parameters that don't let it escape.
+ * visiting holds the parameters being looked at further up, which are
+ * assumed not to escape, so recursive functions can be analyzed.
+ */
+
+int FuncDeclaration::delegateParamEscapes(size_t i, FuncParams *visiting)
+{
+    if (toAliasFunc() != this)
+        return toAliasFunc()->delegateParamEscapes(i, visiting);
+
+    // The analyzed body must be the one that is called
+    if (semanticRun < PASSsemantic3done || semantic3Errors || !fbody ||
+        inlineAsm || (isVirtual() && !isFinal()) ||
+        !parameters || i >= parameters->dim)
+        return 1;
+
+    VarDeclaration *v = (*parameters)[i];
+    if ((v->storage_class & (STCref | STCout | STClazy)) ||
+        v->type->toBasetype()->ty != Tdelegate ||
+        v->nestedrefs.dim || v->escapingRefs > 0)
+        return 1;
+
+    for (size_t j = 0; j < visiting->dim; j++)
+    {   FuncParam *fp = (*visiting)[j];
+        if (fp->fd == this && fp->index == i)
+            return 0;
+    }
+
+    FuncParam self(this, i);
+    visiting->push(&self);
+    int escapes = passedToEscaping(&v->passedTo, visiting);
+    visiting->pop();
+    return escapes;
+}
+#endif
+
 /*******************************
  * Look at all the variables in this function that are referenced
  * by nested functions, and determine if a closure needs to be
@@ -3218,9 +3274,16 @@ int FuncDeclaration::needsClosure()
      * a virtual one, if that non-virtual function accesses a closure
      * var, the closure still has to be taken. Hence, we check for isThis()
      * instead of isVirtual(). (thanks to David Friedman)
+     *
+     * LDC: A function whose address is only passed to parameters that
+     * are known not to let it escape doesn't count for 2), see
+     * delegateParamEscapes().
      */
 
     //printf("FuncDeclaration::needsClosure() %s\n", toChars());
+#if IN_LLVM
+    FuncParams visiting;
+#endif
     for (int i = 0; i < closureVars.dim; i++)
     {   VarDeclaration *v = closureVars.tdata()[i];
         assert(v->isVarDeclaration());
@@ -3233,6 +3296,10 @@ int FuncDeclaration::needsClosure()
             //printf("\t\tf = %s, %d, %p, %d\n", f->toChars(), f->isVirtual(), f->isThis(), f->tookAddressOf);
             if (f->isThis() || f->tookAddressOf)
                 goto Lyes;      // assume f escapes this function's scope
+#if IN_LLVM
+            if (passedToEscaping(&f->passedTo, &visiting))
+                goto Lyes;
+#endif
 
             // Look to see if any parents of f that are below this escape
             for (Dsymbol *s = f->parent; s && s != this; s = s->parent)
@@ -3240,6 +3307,10 @@ int FuncDeclaration::needsClosure()
                 f = s->isFuncDeclaration();
                 if (f && (f->isThis() || f->tookAddressOf))
                     goto Lyes;
+#if IN_LLVM
+                if (f && passedToEscaping(&f->passedTo, &visiting))
+                    goto Lyes;
+#endif
             }
         }
     }
@@ -12,6 +12,7 @@
 #include <assert.h>
 
 #include "rmem.h"
+#include "aav.h"
 
 #include "statement.h"
 #include "expression.h"
@@ -28,6 +29,10 @@
 
 #include "template.h"
 
+#if IN_LLVM
+#include "gen/timereport.h"
+#endif
+
 
 #define LOG     0
 #define LOGASSIGN 0
@@ -190,6 +195,8 @@ struct CtfeStatus
     static int maxCallDepth; // highest number of recursive calls
     static int numArrayAllocs; // Number of allocated arrays
     static int numAssignments; // total number of assignments executed
+    static int numCacheHits; // calls answered from the call cache
+    static int numCacheMisses; // cacheable calls that had to be interpreted
 };
 
 int CtfeStatus::callDepth = 0;
@@ -197,6 +204,8 @@ int CtfeStatus::stackTraceCallsToSuppress = 0;
 int CtfeStatus::maxCallDepth = 0;
 int CtfeStatus::numArrayAllocs = 0;
 int CtfeStatus::numAssignments = 0;
+int CtfeStatus::numCacheHits = 0;
+int CtfeStatus::numCacheMisses = 0;
 
 // CTFE diagnostic information
 void printCtfePerformanceStats()
@@ -204,7 +213,8 @@ void printCtfePerformanceStats()
 #if SHOWPERFORMANCE
     printf("        ---- CTFE Performance ----\n");
     printf("max call depth = %d\tmax stack = %d\n", CtfeStatus::maxCallDepth, ctfeStack.maxStackUsage());
-    printf("array allocs = %d\tassignments = %d\n\n", CtfeStatus::numArrayAllocs, CtfeStatus::numAssignments);
+    printf("array allocs = %d\tassignments = %d\n", CtfeStatus::numArrayAllocs, CtfeStatus::numAssignments);
+    printf("call cache hits = %d\tmisses = %d\n\n", CtfeStatus::numCacheHits, CtfeStatus::numCacheMisses);
 #endif
 }
 
@@ -488,6 +498,171 @@ void showCtfeExpr(Expression *e, int level = 0)
     }
 }
 
+/*************************************
+ * Cache of the results of calls to strongly pure functions.
+ * Such a call always gives the same result for the same argument
+ * values, so it only needs to be interpreted once.
+ */
+
+struct CtfeCallCacheEntry
+{
+    CtfeCallCacheEntry *next;   // next entry with the same hash
+    FuncDeclaration *fd;
+    Expressions *args;          // copies of the argument values
+    Expression *result;         // copy of the returned value
+};
+
+static AA *ctfeCallCache;       // hash => CtfeCallCacheEntry*
+
+/* Is e a literal that can be stored in the call cache?
+ * It must be copied in full by copyLiteral(), which does not copy
+ * arrays and strings inside of struct literals.
+ */
+static bool isCacheableLiteral(Expression *e, bool inStruct)
+{
+    switch (e->op)
+    {
+        case TOKint64:
+        case TOKfloat64:
+        case TOKcomplex80:
+        case TOKnull:
+            return true;
+
+        case TOKstring:
+            return !inStruct;
+
+        case TOKarrayliteral:
+        {   if (inStruct)
+                return false;
+            Expressions *elems = ((ArrayLiteralExp *)e)->elements;
+            for (size_t i = 0; elems && i < elems->dim; i++)
+            {   Expression *elem = (*elems)[i];
+                if (!elem || !isCacheableLiteral(elem, false))
+                    return false;
+            }
+            return true;
+        }
+
+        case TOKstructliteral:
+        {   Expressions *elems = ((StructLiteralExp *)e)->elements;
+            for (size_t i = 0; i < elems->dim; i++)
+            {   Expression *elem = (*elems)[i];
+                if (!elem || !isCacheableLiteral(elem, true))
+                    return false;
+            }
+            return true;
+        }
+
+        default:
+            return false;
+    }
+}
+
+static hash_t cacheableLiteralHash(Expression *e)
+{
+    hash_t h = e->op;
+    switch (e->op)
+    {
+        case TOKint64:
+            h = h * 31 + (hash_t)e->toInteger();
+            break;
+
+        case TOKstring:
+        {   StringExp *se = (StringExp *)e;
+            h = h * 31 + String::calcHash((const char *)se->string, se->len * se->sz);
+            break;
+        }
+
+        case TOKarrayliteral:
+        case TOKstructliteral:
+        {   Expressions *elems = e->op == TOKarrayliteral
+                ? ((ArrayLiteralExp *)e)->elements
+                : ((StructLiteralExp *)e)->elements;
+            for (size_t i = 0; elems && i < elems->dim; i++)
+                h = h * 31 + cacheableLiteralHash((*elems)[i]);
+            break;
+        }
+
+        default:
+            break;
+    }
+    return h;
+}
+
+static bool cacheableLiteralEquals(Expression *e1, Expression *e2)
+{
+    if (e1->op != e2->op)
+        return false;
+    switch (e1->op)
+    {
+        case TOKarrayliteral:
+        case TOKstructliteral:
+        {   Expressions *elems1, *elems2;
+            if (e1->op == TOKarrayliteral)
+            {   elems1 = ((ArrayLiteralExp *)e1)->elements;
+                elems2 = ((ArrayLiteralExp *)e2)->elements;
+            }
+            else
+            {   if (((StructLiteralExp *)e1)->sd != ((StructLiteralExp *)e2)->sd)
+                    return false;
+                elems1 = ((StructLiteralExp *)e1)->elements;
+                elems2 = ((StructLiteralExp *)e2)->elements;
+            }
+            size_t dim1 = elems1 ? elems1->dim : 0;
+            size_t dim2 = elems2 ? elems2->dim : 0;
+            if (dim1 != dim2)
+                return false;
+            for (size_t i = 0; i < dim1; i++)
+            {
+                if (!cacheableLiteralEquals((*elems1)[i], (*elems2)[i]))
+                    return false;
+            }
+            return true;
+        }
+
+        default:
+            return e1->equals(e2) != 0;
+    }
+}
+
+static hash_t ctfeCallHash(FuncDeclaration *fd, Expressions *args)
+{
+    hash_t h = (hash_t)fd;
+    for (size_t i = 0; i < args->dim; i++)
+        h = h * 31 + cacheableLiteralHash((*args)[i]);
+    return h;
+}
+
+static CtfeCallCacheEntry *ctfeCallCacheLookup(FuncDeclaration *fd, Expressions *args, hash_t hash)
+{
+    CtfeCallCacheEntry *entry = (CtfeCallCacheEntry *)_aaGetRvalue(ctfeCallCache, (void *)hash);
+    for (; entry; entry = entry->next)
+    {
+        if (entry->fd != fd || entry->args->dim != args->dim)
+            continue;
+        size_t i = 0;
+        for (; i < args->dim; i++)
+        {
+            if (!cacheableLiteralEquals((*entry->args)[i], (*args)[i]))
+                break;
+        }
+        if (i == args->dim)
+            return entry;
+    }
+    return NULL;
+}
+
+static void ctfeCallCacheInsert(FuncDeclaration *fd, Expressions *args, hash_t hash, Expression *result)
+{
+    CtfeCallCacheEntry **pentry = (CtfeCallCacheEntry **)_aaGet(&ctfeCallCache, (void *)hash);
+    CtfeCallCacheEntry *entry = new CtfeCallCacheEntry();
+    entry->next = *pentry;
+    entry->fd = fd;
+    entry->args = args;
+    entry->result = copyLiteral(result);
+    *pentry = entry;
+}
+
 /*************************************
  * Attempt to interpret a function given the arguments.
  * Input:
@@ -503,6 +678,10 @@ Expression *FuncDeclaration::interpret(InterState *istate, Expressions *argument
 {
 #if LOG
     printf("\n********\nFuncDeclaration::interpret(istate = %p) %s\n", istate, toChars());
+#endif
+#if IN_LLVM
+    // only time the calls from outside of CTFE
+    SymbolTimer timer(SymbolTimer::CTFECall, istate ? NULL : this);
 #endif
     if (semanticRun == PASSsemantic3)
         return EXP_CANT_INTERPRET;
@@ -570,6 +749,12 @@ Expression *FuncDeclaration::interpret(InterState *istate, Expressions *argument
             return EXP_CANT_INTERPRET;
     }
     static int evaluatingArgs = 0;
+
+    /* A strongly pure function only taking its arguments by value
+     * is a candidate for the call cache.
+     */
+    bool cacheable = fbody && !thisarg && !isNested() && isPure() == PUREstrong;
+    Expressions eargs;
     if (arguments)
     {
         dim = arguments->dim;
@@ -579,12 +764,13 @@ Expression *FuncDeclaration::interpret(InterState *istate, Expressions *argument
         /* Evaluate all the arguments to the function,
          * store the results in eargs[]
          */
-        Expressions eargs;
         eargs.setDim(dim);
         for (size_t i = 0; i < dim; i++)
         {   Expression *earg = arguments->tdata()[i];
             Parameter *arg = Parameter::getNth(tf->parameters, i);
 
+            if (arg->storageClass & (STCout | STCref | STClazy))
+                cacheable = false;
             if (arg->storageClass & (STCout | STCref))
             {
                 if (!istate && (arg->storageClass & STCout))
@@ -636,6 +822,8 @@ Expression *FuncDeclaration::interpret(InterState *istate, Expressions *argument
                 return EXP_CANT_INTERPRET;
             }
             eargs.tdata()[i] = earg;
+            if (cacheable && !isCacheableLiteral(earg, false))
+                cacheable = false;
         }
 
         for (size_t i = 0; i < dim; i++)
@@ -676,6 +864,31 @@ Expression *FuncDeclaration::interpret(InterState *istate, Expressions *argument
         }
     }
 
+    /* Look up the call in the cache, and remember the
+     * arguments before the function body gets to modify them.
+     */
+    hash_t cachehash = 0;
+    Expressions *cacheargs = NULL;
+    if (cacheable)
+    {
+        cachehash = ctfeCallHash(this, &eargs);
+        CtfeCallCacheEntry *entry = ctfeCallCacheLookup(this, &eargs, cachehash);
+        if (entry)
+        {
+            ++CtfeStatus::numCacheHits;
+            ctfeStack.endFrame(istatex.framepointer);
+            Expression *e = copyLiteral(entry->result);
+            if (!istate && !evaluatingArgs)
+                e = scrubReturnValue(loc, e);
+            return e;
+        }
+        ++CtfeStatus::numCacheMisses;
+        cacheargs = new Expressions();
+        cacheargs->setDim(dim);
+        for (size_t i = 0; i < dim; i++)
+            (*cacheargs)[i] = copyLiteral(eargs[i]);
+    }
+
     if (vresult)
         ctfeStack.push(vresult);
 
@@ -740,6 +953,9 @@ Expression *FuncDeclaration::interpret(InterState *istate, Expressions *argument
         return EXP_CANT_INTERPRET;
     }
 
+    if (cacheargs && isCacheableLiteral(e, false))
+        ctfeCallCacheInsert(this, cacheargs, cachehash, e);
+
     // If we're about to leave CTFE, make sure we don't crash the
     // compiler by returning a CTFE-internal expression.
     if (!istate && !evaluatingArgs)
@@ -967,6 +1183,153 @@ Expression *ctfeEqual(Loc loc, enum TOK op, Type *type, Expression *e1, Expressi
     return e;
 }
 
+/*************************************
+ * Hash index over the keys of an associative array literal.
+ * The literal remains the canonical representation of the AA;
+ * the index only saves findKeyInAA() from comparing against every key.
+ * It is built on the first lookup and extended lazily as keys are
+ * appended. Several literals may share one keys[] (and thus one index).
+ */
+
+struct CtfeAAIndex
+{
+    Expressions *keys;  // keys[] this index was built for
+    size_t dim;         // number of keys[] entries indexed so far
+    bool unhashable;    // a key cannot be hashed, always search linearly
+    AA *positions;      // hash => Array of indices into keys[]
+};
+
+// Smaller AAs are just searched linearly
+#define CTFE_AA_INDEX_MIN 16
+
+/* Compute a hash of the key e which is consistent with ctfeEqual().
+ * Return false if e cannot be hashed.
+ */
+static bool ctfeKeyHash(Expression *e, hash_t *phash)
+{
+    if (e->op == TOKslice)
+        e = resolveSlice(e);
+    switch (e->op)
+    {
+        case TOKint64:
+            *phash = (hash_t)e->toInteger();
+            return true;
+
+        case TOKfloat64:
+        case TOKcomplex80:
+            // 0.0 == -0.0, so the bits cannot be used
+            *phash = e->op;
+            return true;
+
+        case TOKnull:
+            // Same as an empty string or array literal
+            *phash = 0;
+            return true;
+
+        case TOKstring:
+        {   StringExp *se = (StringExp *)e;
+            hash_t h = se->len;
+            for (size_t i = 0; i < se->len; i++)
+                h = h * 31 + se->charAt(i);
+            *phash = h;
+            return true;
+        }
+
+        case TOKarrayliteral:
+        {   Expressions *elems = ((ArrayLiteralExp *)e)->elements;
+            size_t dim = elems ? elems->dim : 0;
+            hash_t h = dim;
+            for (size_t i = 0; i < dim; i++)
+            {   Expression *elem = (*elems)[i];
+                hash_t eh;
+                if (!elem || !ctfeKeyHash(elem, &eh))
+                    return false;
+                h = h * 31 + eh;
+            }
+            *phash = h;
+            return true;
+        }
+
+        case TOKstructliteral:
+        {   Expressions *elems = ((StructLiteralExp *)e)->elements;
+            size_t dim = elems ? elems->dim : 0;
+            hash_t h = dim;
+            for (size_t i = 0; i < dim; i++)
+            {   Expression *elem = (*elems)[i];
+                hash_t eh = 0;
+                if (elem && !ctfeKeyHash(elem, &eh))
+                    return false;
+                h = h * 31 + eh;
+            }
+            *phash = h;
+            return true;
+        }
+
+        default:
+            return false;
+    }
+}
+
+static CtfeAAIndex *newAAIndex(Expressions *keys)
+{
+    CtfeAAIndex *index = new CtfeAAIndex();
+    index->keys = keys;
+    index->dim = 0;
+    index->unhashable = false;
+    index->positions = NULL;
+    return index;
+}
+
+/* Discard the contents of index, e.g. after keys have been removed.
+ * The index is reset in place since other literals may share it.
+ */
+static void resetAAIndex(CtfeAAIndex *index, Expressions *keys)
+{
+    index->keys = keys;
+    index->dim = 0;
+    index->unhashable = false;
+    index->positions = NULL;
+}
+
+/* Look up the positions in ae->keys[] which may hold key.
+ * Return false if the index cannot be used, in which case the
+ * caller must search all of the keys. Otherwise *ppositions is set
+ * to the candidate positions in ascending order, or NULL if there are none.
+ */
+static bool lookupAAIndex(AssocArrayLiteralExp *ae, Expression *key, Array **ppositions)
+{
+    Expressions *keys = ae->keys;
+    if (!keys || keys->dim < CTFE_AA_INDEX_MIN)
+        return false;
+
+    CtfeAAIndex *index = ae->ctfeIndex;
+    if (!index)
+        index = ae->ctfeIndex = newAAIndex(keys);
+    else if (index->keys != keys || index->dim > keys->dim)
+        resetAAIndex(index, keys);
+    if (index->unhashable)
+        return false;
+
+    // Index any keys which were appended since the last lookup
+    for (; index->dim < keys->dim; index->dim++)
+    {   hash_t h;
+        if (!ctfeKeyHash((*keys)[index->dim], &h))
+        {   index->unhashable = true;
+            return false;
+        }
+        Array **pa = (Array **)_aaGet(&index->positions, (void *)h);
+        if (!*pa)
+            *pa = new Array();
+        (*pa)->push((void *)index->dim);
+    }
+
+    hash_t h;
+    if (!ctfeKeyHash(key, &h))
+        return false;
+    *ppositions = (Array *)_aaGetRvalue(index->positions, (void *)h);
+    return true;
+}
+
 Expression *ctfeCat(Type *type, Expression *e1, Expression *e2)
 {
     Loc loc = e1->loc;
@@ -3131,6 +3494,23 @@ Expression *assignAssocArrayElement(Loc loc, AssocArrayLiteralExp *aae, Expressi
     Expressions *keysx = aae->keys;
     Expressions *valuesx = aae->values;
     int updated = 0;
+    Array *positions;
+    if (lookupAAIndex(aae, index, &positions))
+    {
+        for (size_t k = positions ? positions->dim : 0; k; )
+        {   k--;
+            size_t j = (size_t)positions->data[k];
+            Expression *ekey = aae->keys->tdata()[j];
+            Expression *ex = ctfeEqual(loc, TOKequal, Type::tbool, ekey, index);
+            if (exceptionOrCantInterpret(ex))
+                return ex;
+            if (ex->isBool(TRUE))
+            {   valuesx->tdata()[j] = newval;
+                updated = 1;
+            }
+        }
+    }
+    else
     for (size_t j = valuesx->dim; j; )
     {   j--;
         Expression *ekey = aae->keys->tdata()[j];
@@ -3412,8 +3792,13 @@ Expression *paintTypeOntoLiteral(Type *type, Expression *lit)
         // TODO: we should be creating a reference to this AAExp, not
         // just a ref to the keys and values.
         bool wasOwned = aae->ownedByCtfe;
+        // Both literals share keys[], so they must share its index as well
+        if (!aae->ctfeIndex)
+            aae->ctfeIndex = newAAIndex(aae->keys);
+        CtfeAAIndex *index = aae->ctfeIndex;
         aae = new AssocArrayLiteralExp(lit->loc, aae->keys, aae->values);
         aae->ownedByCtfe = wasOwned;
+        aae->ctfeIndex = index;
         e = aae;
     }
     else
@@ -5160,6 +5545,25 @@ Expression *findKeyInAA(Loc loc, AssocArrayLiteralExp *ae, Expression *e2)
 {
     /* Search the keys backwards, in case there are duplicate keys
      */
+    Array *positions;
+    if (lookupAAIndex(ae, e2, &positions))
+    {
+        for (size_t j = positions ? positions->dim : 0; j;)
+        {
+            j--;
+            size_t i = (size_t)positions->data[j];
+            Expression *ekey = ae->keys->tdata()[i];
+            Expression *ex = ctfeEqual(loc, TOKequal, Type::tbool, ekey, e2);
+            if (ex == EXP_CANT_INTERPRET)
+                return ex;
+            if (ex->isBool(TRUE))
+            {
+                return ae->values->tdata()[i];
+            }
+        }
+        return NULL;
+    }
+
     for (size_t i = ae->keys->dim; i;)
     {
         i--;
@@ -6101,6 +6505,8 @@ Expression *RemoveExp::interpret(InterState *istate, CtfeGoal goal)
     }
     valuesx->dim = valuesx->dim - removed;
     keysx->dim = keysx->dim - removed;
+    if (removed && aae->ctfeIndex)
+        resetAAIndex(aae->ctfeIndex, keysx);
     return new IntegerExp(loc, removed?1:0, Type::tbool);
 }
 
@@ -275,6 +275,7 @@ struct Param
 
     // Codegen cl options
     bool singleObj;
+    bool templatesOnce;
     bool disableRedZone;
     bool noVerify;
 #endif
@@ -214,6 +214,9 @@ struct Module : Package
     AA *arrayfuncs;
 
     bool isRoot;
+
+    // files read by import("file") expressions in this module
+    Strings stringImports;
 #endif
 };
 
@@ -361,53 +361,42 @@ hash_t Dchar::calcHash(const dchar *str, size_t len)
 
 #else // ascii
 
+/*************************************
+ * MurmurHash2 by Austin Appleby: it hashes four bytes at a time and
+ * mixes all of them into the low bits, which StringTable uses to pick
+ * the slot.
+ */
+
 hash_t Dchar::calcHash(const dchar *str, size_t len)
 {
-    hash_t hash = 0;
+    const uint32_t m = 0x5BD1E995;
+    const uint8_t *data = (const uint8_t *)str;
+    uint32_t hash = 0x9747B28C ^ (uint32_t)len;
 
-    while (1)
+    while (len >= 4)
     {
-        switch (len)
-        {
-            case 0:
-                return hash;
-
-            case 1:
-                hash *= 37;
-                hash += *(const uint8_t *)str;
-                return hash;
-
-            case 2:
-                hash *= 37;
-#if LITTLE_ENDIAN
-                hash += *(const uint16_t *)str;
-#else
-                hash += str[0] * 256 + str[1];
-#endif
-                return hash;
-
-            case 3:
-                hash *= 37;
-#if LITTLE_ENDIAN
-                hash += (*(const uint16_t *)str << 8) +
-                        ((const uint8_t *)str)[2];
-#else
-                hash += (str[0] * 256 + str[1]) * 256 + str[2];
-#endif
-                return hash;
+        uint32_t k = data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+        k *= m;
+        k ^= k >> 24;
+        k *= m;
+        hash *= m;
+        hash ^= k;
+        data += 4;
+        len -= 4;
+    }
 
-            default:
-                hash *= 37;
-#if LITTLE_ENDIAN
-                hash += *(const uint32_t *)str;
-#else
-                hash += ((str[0] * 256 + str[1]) * 256 + str[2]) * 256 + str[3];
-#endif
-                str += 4;
-                len -= 4;
-                break;
-        }
+    switch (len)
+    {
+        case 3: hash ^= data[2] << 16;
+        case 2: hash ^= data[1] << 8;
+        case 1: hash ^= data[0];
+                hash *= m;
     }
+
+    hash ^= hash >> 13;
+    hash *= m;
+    hash ^= hash >> 15;
+    return hash;
 }
 
 hash_t Dchar::icalcHash(const dchar *str, size_t len)
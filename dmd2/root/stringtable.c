@@ -20,30 +20,26 @@
 
 void StringTable::init(unsigned size)
 {
-    table = (void **)mem.calloc(size, sizeof(void *));
-    tabledim = size;
+    // Round up to a power of 2, so a slot index is just the low bits of the hash
+    tabledim = 16;
+    while (tabledim < size)
+        tabledim <<= 1;
+    table = (StringSlot *)mem.calloc(tabledim, sizeof(StringSlot));
     count = 0;
+    searches = 0;
+    probes = 0;
+    resizes = 0;
 }
 
 StringTable::~StringTable()
 {
-    unsigned i;
-
-    // Zero out dangling pointers to help garbage collector.
-    // Should zero out StringEntry's too.
-    for (i = 0; i < count; i++)
-        table[i] = NULL;
-
+    // The StringEntry's are not freed, the StringValue's may still be referenced.
     mem.free(table);
     table = NULL;
 }
 
 struct StringEntry
 {
-    StringEntry *left;
-    StringEntry *right;
-    hash_t hash;
-
     StringValue value;
 
     static StringEntry *alloc(const dchar *s, unsigned len);
@@ -55,85 +51,103 @@ StringEntry *StringEntry::alloc(const dchar *s, unsigned len)
 
     se = (StringEntry *) mem.calloc(1,sizeof(StringEntry) - sizeof(Lstring) + Lstring::size(len));
     se->value.lstring.length = len;
-    se->hash = Dchar::calcHash(s,len);
     memcpy(se->value.lstring.string, s, len * sizeof(dchar));
     return se;
 }
 
-void **StringTable::search(const dchar *s, unsigned len)
+/***********************************
+ * Find the slot holding s, or the empty slot where s would go.
+ * Probes triangular number offsets from the home slot, which visits
+ * every slot of a power of 2 sized table.
+ */
+
+StringSlot *StringTable::search(const dchar *s, unsigned len, hash_t hash)
 {
-    hash_t hash;
-    unsigned u;
-    int cmp;
-    StringEntry **se;
+    unsigned mask = tabledim - 1;
+    unsigned u = hash & mask;
+    unsigned step = 0;
 
     //printf("StringTable::search(%p,%d)\n",s,len);
-    hash = Dchar::calcHash(s,len);
-    u = hash % tabledim;
-    se = (StringEntry **)&table[u];
-    //printf("\thash = %d, u = %d\n",hash,u);
-    while (*se)
+    searches++;
+    while (1)
     {
-        cmp = (*se)->hash - hash;
-        if (cmp == 0)
+        StringSlot *slot = &table[u];
+        probes++;
+        if (!slot->entry)
+            return slot;
+        if (slot->hash == hash)
         {
-            cmp = (*se)->value.lstring.len() - len;
-            if (cmp == 0)
-            {
-                cmp = Dchar::memcmp(s,(*se)->value.lstring.toDchars(),len);
-                if (cmp == 0)
-                    break;
-            }
+            Lstring *ls = &slot->entry->value.lstring;
+            if (ls->len() == len && Dchar::memcmp(s, ls->toDchars(), len) == 0)
+                return slot;
         }
-        if (cmp < 0)
-            se = &(*se)->left;
-        else
-            se = &(*se)->right;
+        step++;
+        u = (u + step) & mask;
     }
-    //printf("\treturn %p, %p\n",se, (*se));
-    return (void **)se;
 }
 
-StringValue *StringTable::lookup(const dchar *s, unsigned len)
-{   StringEntry *se;
-
-    se = *(StringEntry **)search(s,len);
-    if (se)
-        return &se->value;
-    else
-        return NULL;
-}
+void StringTable::grow()
+{
+    StringSlot *oldtable = table;
+    unsigned olddim = tabledim;
 
-StringValue *StringTable::update(const dchar *s, unsigned len)
-{   StringEntry **pse;
-    StringEntry *se;
+    tabledim = olddim * 2;
+    table = (StringSlot *)mem.calloc(tabledim, sizeof(StringSlot));
+    resizes++;
 
-    pse = (StringEntry **)search(s,len);
-    se = *pse;
-    if (!se)                    // not in table: so create new entry
+    unsigned mask = tabledim - 1;
+    for (unsigned i = 0; i < olddim; i++)
     {
-        se = StringEntry::alloc(s, len);
-        *pse = se;
+        if (!oldtable[i].entry)
+            continue;
+        unsigned u = oldtable[i].hash & mask;
+        unsigned step = 0;
+        while (table[u].entry)
+        {
+            step++;
+            u = (u + step) & mask;
+        }
+        table[u] = oldtable[i];
     }
-    return &se->value;
+    mem.free(oldtable);
 }
 
-StringValue *StringTable::insert(const dchar *s, unsigned len)
-{   StringEntry **pse;
-    StringEntry *se;
-
-    pse = (StringEntry **)search(s,len);
-    se = *pse;
-    if (se)
-        return NULL;            // error: already in table
-    else
-    {
-        se = StringEntry::alloc(s, len);
-        *pse = se;
-    }
+StringValue *StringTable::add(StringSlot *slot, const dchar *s, unsigned len, hash_t hash)
+{
+    StringEntry *se = StringEntry::alloc(s, len);
+    slot->hash = hash;
+    slot->entry = se;
+    count++;
+
+    // Keep the load factor at most 2/3, so the probe sequences stay short
+    if (count * 3 > tabledim * 2)
+        grow();
     return &se->value;
 }
 
+StringValue *StringTable::lookup(const dchar *s, unsigned len)
+{
+    StringSlot *slot = search(s, len, Dchar::calcHash(s,len));
+    if (slot->entry)
+        return &slot->entry->value;
+    else
+        return NULL;
+}
 
+StringValue *StringTable::update(const dchar *s, unsigned len)
+{
+    hash_t hash = Dchar::calcHash(s,len);
+    StringSlot *slot = search(s, len, hash);
+    if (slot->entry)
+        return &slot->entry->value;
+    return add(slot, s, len, hash);     // not in table: so create new entry
+}
 
-
+StringValue *StringTable::insert(const dchar *s, unsigned len)
+{
+    hash_t hash = Dchar::calcHash(s,len);
+    StringSlot *slot = search(s, len, hash);
+    if (slot->entry)
+        return NULL;            // error: already in table
+    return add(slot, s, len, hash);
+}
@@ -28,11 +28,29 @@ struct StringValue
     Lstring lstring;
 };
 
+struct StringEntry;
+
+struct StringSlot
+{
+    hash_t hash;
+    StringEntry *entry;         // NULL if the slot is empty
+};
+
+/* An open addressing hash table, which doubles its size when it gets
+ * more than 2/3 full. The entries never move, so the StringValue's
+ * stay valid.
+ */
+
 struct StringTable
 {
-    void **table;
+    StringSlot *table;
     unsigned count;
-    unsigned tabledim;
+    unsigned tabledim;          // always a power of 2
+
+    // Statistics
+    size_t searches;            // number of lookups, inserts and updates
+    size_t probes;              // number of slots looked at by them
+    unsigned resizes;
 
     void init(unsigned size = 37);
     ~StringTable();
@@ -41,8 +59,13 @@ struct StringTable
     StringValue *insert(const dchar *s, unsigned len);
     StringValue *update(const dchar *s, unsigned len);
 
+    double loadFactor() { return tabledim ? (double)count / tabledim : 0; }
+    double probesPerSearch() { return searches ? (double)probes / searches : 0; }
+
 private:
-    void **search(const dchar *s, unsigned len);
+    StringSlot *search(const dchar *s, unsigned len, hash_t hash);
+    StringValue *add(StringSlot *slot, const dchar *s, unsigned len, hash_t hash);
+    void grow();
 };
 
 #endif
@@ -30,6 +30,9 @@
 #include "dsymbol.h"
 #include "hdrgen.h"
 #include "id.h"
+#if IN_LLVM
+#include "gen/timereport.h"
+#endif
 
 #if WINDOWS_SEH
 #include <windows.h>
@@ -278,6 +281,158 @@ int arrayObjectMatch(Objects *oa1, Objects *oa2, TemplateDeclaration *tempdecl,
     return 1;
 }
 
+/******************************
+ * Compute a hash of e that agrees with Expression::equals().
+ * Returns 0 if e cannot be hashed.
+ */
+
+static int expressionHash(Expression *e, hash_t *phash)
+{
+    hash_t h = e->op;
+    switch (e->op)
+    {
+        case TOKint64:
+            h = h * 31 + (hash_t)((IntegerExp *)e)->value;
+            break;
+
+        case TOKfloat64:
+        case TOKcomplex80:
+        case TOKnull:
+            break;
+
+        case TOKstring:
+            h = h * 31 + ((StringExp *)e)->len;
+            break;
+
+        case TOKvar:
+            h = h * 31 + (hash_t)((VarExp *)e)->var;
+            break;
+
+        case TOKtuple:
+        {   Expressions *exps = ((TupleExp *)e)->exps;
+            for (size_t i = 0; i < exps->dim; i++)
+            {   hash_t h2;
+                if (!expressionHash((*exps)[i], &h2))
+                    return 0;
+                h = h * 31 + h2;
+            }
+            break;
+        }
+
+        default:
+            // No equals() override, so only identical expressions match
+            h = (hash_t)e;
+            break;
+    }
+    *phash = h;
+    return 1;
+}
+
+/******************************
+ * Compute a hash of o such that if match(o1, o2),
+ * then o1 and o2 have the same hash.
+ * Returns 0 if o cannot be hashed, for example because it is a type
+ * that has not been through semantic() yet.
+ */
+
+static int objectHash(Object *o, hash_t *phash)
+{
+    Type *t = isType(o);
+    Expression *e = isExpression(o);
+    Dsymbol *s = isDsymbol(o);
+    Tuple *u = isTuple(o);
+
+    if (s)
+    {   // match() compares manifest constants by their value
+        VarDeclaration *v = s->isVarDeclaration();
+        if (v && v->storage_class & STCmanifest && v->init)
+        {   ExpInitializer *ei = v->init->isExpInitializer();
+            if (ei)
+                e = ei->exp, s = NULL;
+        }
+    }
+
+    if (t)
+    {   // deco strings are unique, see Type::equals()
+        if (!t->deco)
+            return 0;
+        *phash = String::calcHash(t->deco);
+    }
+    else if (e)
+        return expressionHash(e, phash);
+    else if (s)
+    {   // match() needs equal identifiers and the same parent
+        if (s->ident)
+            *phash = (hash_t)s->parent * 31 + s->ident->hashCode();
+        else
+            *phash = (hash_t)s;
+    }
+    else if (u)
+    {   hash_t h = DYNCAST_TUPLE;
+        for (size_t i = 0; i < u->objects.dim; i++)
+        {   hash_t h2;
+            if (!objectHash(u->objects[i], &h2))
+                return 0;
+            h = h * 31 + h2;
+        }
+        *phash = h;
+    }
+    else
+        return 0;       // NULL matches anything
+    return 1;
+}
+
+/************************************
+ * Return !=0 if one of oa[] is a type that is an instance of tempdecl
+ * which is being expanded in sc, i.e. if match() would complain about
+ * a recursive template expansion.
+ */
+
+static int arrayObjectIsRecursive(Objects *oa, TemplateDeclaration *tempdecl, Scope *sc)
+{
+    for (size_t j = 0; j < oa->dim; j++)
+    {   Object *o = oa->tdata()[j];
+        Tuple *u = isTuple(o);
+        if (u)
+        {   if (arrayObjectIsRecursive(&u->objects, tempdecl, sc))
+                return 1;
+            continue;
+        }
+        Type *t = isType(o);
+        if (!t)
+            continue;
+        Dsymbol *s = t->toDsymbol(sc);
+        if (s && s->parent)
+        {   TemplateInstance *ti1 = s->parent->isTemplateInstance();
+            if (ti1 && ti1->tempdecl == tempdecl)
+            {
+                for (Scope *sc1 = sc; sc1; sc1 = sc1->enclosing)
+                {
+                    if (sc1->scopesym == ti1)
+                        return 1;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+/************************************
+ * Hash an array of them.
+ */
+int arrayObjectHash(Objects *oa, hash_t *phash)
+{
+    hash_t h = oa->dim;
+    for (size_t j = 0; j < oa->dim; j++)
+    {   hash_t h2;
+        if (!objectHash(oa->tdata()[j], &h2))
+            return 0;
+        h = h * 31 + h2;
+    }
+    *phash = h;
+    return 1;
+}
+
 /****************************************
  * This makes a 'pretty' version of the template arguments.
  * It's analogous to genIdent() which makes a mangled version.
@@ -383,6 +538,7 @@ TemplateDeclaration::TemplateDeclaration(Loc loc, Identifier *id,
     this->onemember = NULL;
     this->literal = 0;
     this->ismixin = ismixin;
+    this->instancesByHash = NULL;
     this->previous = NULL;
 
     // Compute in advance for Ddoc's use
@@ -661,6 +817,47 @@ void TemplateDeclaration::makeParamNamesVisibleInConstraint(Scope *paramscope, E
     }
 }
 
+/***************************************
+ * Record ti as an instance of this TemplateDeclaration,
+ * indexed by the hash of its tdtypes[].
+ */
+
+void TemplateDeclaration::addInstance(TemplateInstance *ti)
+{
+    instances.push(ti);
+    ti->hashable = arrayObjectHash(&ti->tdtypes, &ti->hash);
+    if (ti->hashable)
+    {
+        TemplateInstances **pinsts = (TemplateInstances **)_aaGet(&instancesByHash, (void *)ti->hash);
+        if (!*pinsts)
+            *pinsts = new TemplateInstances();
+        (*pinsts)->push(ti);
+    }
+    else
+        unhashedInstances.push(ti);
+}
+
+/***************************************
+ * Undo addInstance() for instances[idx].
+ */
+
+void TemplateDeclaration::removeInstance(size_t idx)
+{
+    TemplateInstance *ti = instances[idx];
+    instances.remove(idx);
+
+    TemplateInstances *insts = ti->hashable
+        ? (TemplateInstances *)_aaGetRvalue(instancesByHash, (void *)ti->hash)
+        : &unhashedInstances;
+    for (size_t i = insts->dim; i-- > 0; )
+    {
+        if ((*insts)[i] == ti)
+        {   insts->remove(i);
+            break;
+        }
+    }
+}
+
 /***************************************
  * Given that ti is an instance of this TemplateDeclaration,
  * deduce the types of the parameters to this, and store
@@ -4279,6 +4476,8 @@ TemplateInstance::TemplateInstance(Loc loc, Identifier *ident)
     this->isnested = NULL;
     this->speculative = 0;
     this->ignore = true;
+    this->hashable = 0;
+    this->hash = 0;
 
 #if IN_LLVM
     this->emittedInModule = NULL;
@@ -4313,6 +4512,8 @@ TemplateInstance::TemplateInstance(Loc loc, TemplateDeclaration *td, Objects *ti
     this->isnested = NULL;
     this->speculative = 0;
     this->ignore = true;
+    this->hashable = 0;
+    this->hash = 0;
 
 #if IN_LLVM
     this->tinst = NULL;
@@ -4459,6 +4660,9 @@ void TemplateInstance::semantic(Scope *sc, Expressions *fargs)
 #endif
         return;
     }
+#if IN_LLVM
+    SymbolTimer timer(SymbolTimer::TemplateInstantiation, this);
+#endif
     
     if (!sc->ignoreTemplates)
         ignore = false;
@@ -4534,11 +4738,29 @@ void TemplateInstance::semantic(Scope *sc, Expressions *fargs)
 
     /* See if there is an existing TemplateInstantiation that already
      * implements the typeargs. If so, just refer to that one instead.
+     * Only the instances with the same hash of tdtypes, and those that
+     * could not be hashed, need to be looked at. A recursive expansion is
+     * diagnosed by match() when comparing against any existing instance,
+     * so scan all of them then.
      */
+    TemplateInstances *candidates[2];
+    size_t ncandidates = 0;
+    hash_t tdhash;
+    if (!arrayObjectIsRecursive(&tdtypes, tempdecl, sc) &&
+        arrayObjectHash(&tdtypes, &tdhash))
+    {
+        candidates[ncandidates] = (TemplateInstances *)_aaGetRvalue(tempdecl->instancesByHash, (void *)tdhash);
+        if (candidates[ncandidates])
+            ncandidates++;
+        candidates[ncandidates++] = &tempdecl->unhashedInstances;
+    }
+    else
+        candidates[ncandidates++] = &tempdecl->instances;
 
-    for (size_t i = 0; i < tempdecl->instances.dim; i++)
+    for (size_t c = 0; c < ncandidates; c++)
+    for (size_t i = 0; i < candidates[c]->dim; i++)
     {
-        TemplateInstance *ti = tempdecl->instances.tdata()[i];
+        TemplateInstance *ti = candidates[c]->tdata()[i];
 #if LOG
         printf("\t%s: checking for match with instance %d (%p): '%s'\n", toChars(), i, ti, ti->toChars());
 #endif
@@ -4629,7 +4851,7 @@ void TemplateInstance::semantic(Scope *sc, Expressions *fargs)
         speculative = 1;
 
     int tempdecl_instance_idx = tempdecl->instances.dim;
-    tempdecl->instances.push(this);
+    tempdecl->addInstance(this);
     parent = tempdecl->parent;
     //printf("parent = '%s'\n", parent->kind());
 
@@ -4874,7 +5096,7 @@ void TemplateInstance::semantic(Scope *sc, Expressions *fargs)
             // instance/symbol lists we added it to and reset our state to
             // finish clean and so we can try to instantiate it again later
             // (see bugzilla 4302 and 6602).
-            tempdecl->instances.remove(tempdecl_instance_idx);
+            tempdecl->removeInstance(tempdecl_instance_idx);
             if (target_symbol_list)
             {
                 // Because we added 'this' in the last position above, we
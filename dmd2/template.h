@@ -40,6 +40,7 @@ struct Expression;
 struct AliasDeclaration;
 struct FuncDeclaration;
 struct HdrGenState;
+struct AA;
 enum MATCH;
 enum PASS;
 
@@ -58,6 +59,8 @@ struct TemplateDeclaration : ScopeDsymbol
     TemplateParameters *origParameters; // originals for Ddoc
     Expression *constraint;
     TemplateInstances instances;        // array of TemplateInstance's
+    AA *instancesByHash;                // hash of tdtypes => TemplateInstances*
+    TemplateInstances unhashedInstances; // instances whose tdtypes can't be hashed
 
     TemplateDeclaration *overnext;      // next overloaded TemplateDeclaration
     TemplateDeclaration *overroot;      // first in overnext list
@@ -104,6 +107,9 @@ struct TemplateDeclaration : ScopeDsymbol
     int isOverloadable();
 
     void makeParamNamesVisibleInConstraint(Scope *paramscope, Expressions *fargs);
+
+    void addInstance(TemplateInstance *ti);
+    void removeInstance(size_t idx);
 #if IN_LLVM
     // LDC
     std::string intrinsicName;
@@ -305,6 +311,8 @@ struct TemplateInstance : ScopeDsymbol
     Dsymbol *isnested;  // if referencing local symbols, this is the context
     int speculative;    // 1 if only instantiated with errors gagged
     bool ignore;        // true if the instance must be ignored when codegen'ing
+    int hashable;       // 1 if tdtypes could be hashed
+    hash_t hash;        // hash of tdtypes, see arrayObjectHash()
 #ifdef IN_GCC
     /* On some targets, it is necessary to know whether a symbol
        will be emitted in the output or not before the symbol
@@ -393,6 +401,7 @@ Dsymbol *isDsymbol(Object *o);
 Type *isType(Object *o);
 Tuple *isTuple(Object *o);
 int arrayObjectIsError(Objects *args);
+int arrayObjectHash(Objects *oa, hash_t *phash);
 int isError(Object *o);
 Type *getType(Object *o);
 Dsymbol *getDsymbol(Object *o);
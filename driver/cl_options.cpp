@@ -383,10 +383,25 @@ cl::opt<bool, true> singleObj("singleobj",
     cl::desc("Create only a single output object file"),
     cl::location(global.params.singleObj));
 
+cl::opt<bool, true> templatesOnce("templates-once",
+    cl::desc("Emit each template instance into only one of the object files of this build"),
+    cl::location(global.params.templatesOnce),
+    cl::init(true));
+
 cl::opt<bool> linkonceTemplates("linkonce-templates",
     cl::desc("Use linkonce_odr linkage for template symbols instead of weak_odr"),
     cl::ZeroOrMore);
 
+cl::opt<std::string> objectCacheDir("cache",
+    cl::desc("Reuse the object files of unchanged modules from <dir> and store new ones there"),
+    cl::value_desc("dir"));
+
+cl::opt<unsigned> numJobs("j",
+    cl::desc("Optimize and emit up to <N> modules in parallel"),
+    cl::value_desc("N"),
+    cl::Prefix,
+    cl::init(1));
+
 static cl::extrahelp footer("\n"
 "-d-debug can also be specified without options, in which case it enables all\n"
 "debug checks (i.e. (asserts, boundchecks, contracts and invariants) as well\n"
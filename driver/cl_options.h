@@ -51,7 +51,10 @@ namespace opts {
     extern cl::opt<llvm::Reloc::Model> mRelocModel;
     extern cl::opt<llvm::CodeModel::Model> mCodeModel;
     extern cl::opt<bool, true> singleObj;
+    extern cl::opt<bool, true> templatesOnce;
     extern cl::opt<bool> linkonceTemplates;
+    extern cl::opt<unsigned> numJobs;
+    extern cl::opt<std::string> objectCacheDir;
 
     // Arguments to -d-debug
     extern std::vector<std::string> debugArgs;
@@ -60,7 +60,7 @@ static llvm::sys::Path gExePath;
 
 int linkExecutable(const char* argv0)
 {
-    Logger::println("*** Linking executable ***");
+    IF_LOG Logger::println("*** Linking executable ***");
 
     // error string
     std::string errstr;
@@ -221,7 +221,7 @@ int linkExecutable(const char* argv0)
 
 int linkObjToBinary(bool sharedLib)
 {
-    Logger::println("*** Linking executable ***");
+    IF_LOG Logger::println("*** Linking executable ***");
 
     // error string
     std::string errstr;
@@ -369,7 +369,7 @@ int linkObjToBinary(bool sharedLib)
         fflush(stdout);
     }
 
-    Logger::println("Linking with: ");
+    IF_LOG Logger::println("Linking with: ");
     std::vector<const char*>::const_iterator I = args.begin(), E = args.end();
     Stream logstr = Logger::cout();
     for (; I != E; ++I)
@@ -397,7 +397,7 @@ int linkObjToBinary(bool sharedLib)
 
 void createStaticLibrary()
 {
-    Logger::println("*** Creating static library ***");
+    IF_LOG Logger::println("*** Creating static library ***");
 
     // error string
     std::string errstr;
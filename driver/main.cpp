@@ -34,6 +34,7 @@
 #include "gen/irstate.h"
 #include "gen/optimizer.h"
 #include "gen/metadata.h"
+#include "gen/timereport.h"
 #include "gen/passes/Passes.h"
 
 #include "driver/linker.h"
@@ -43,6 +44,7 @@ using namespace opts;
 
 #include "driver/configfile.h"
 #include "driver/toobj.h"
+#include "driver/objcache.h"
 
 #if POSIX
 #include <errno.h>
@@ -122,6 +124,14 @@ static void processVersions(std::vector<std::string>& list, char* type,
     }
 }
 
+// Prints the peak memory usage of the compiler for -v.
+static void printPeakMemory()
+{
+    size_t peak = peakMemoryUsage();
+    if (peak)
+        printf("peak rss  %lu KB\n", (unsigned long)(peak / 1024));
+}
+
 // Helper function to handle -of, -od, etc.
 static void initFromString(char*& dest, const cl::opt<std::string>& src) {
     dest = 0;
@@ -290,6 +300,12 @@ LDC_TARGETS
         opts::linkonceTemplates ? LLGlobalValue::LinkOnceODRLinkage
                                 : LLGlobalValue::WeakODRLinkage;
 
+    // A linkonce_odr template instance may be dropped from the one object
+    // file that defines it if that module doesn't use it itself, so every
+    // module has to emit the instances it uses.
+    if (opts::linkonceTemplates)
+        global.params.templatesOnce = false;
+
     if (global.params.run || !runargs.empty()) {
         // FIXME: how to properly detect the presence of a PositionalEatsArgs
         // option without parameters? We want to emit an error in that case...
@@ -405,6 +421,12 @@ LDC_TARGETS
     if (!global.params.obj || !global.params.output_o || createStaticLib)
         global.params.link = 0;
 
+    // for link-time optimization of an executable, all modules are linked
+    // into one and optimized as a whole program
+    bool linkTimeOpt = doLTO() && global.params.link && !createSharedLib;
+    if (linkTimeOpt)
+        singleObj = true;
+
     if (createStaticLib && createSharedLib)
         error("-lib and -shared switches cannot be used together");
 
@@ -858,6 +880,7 @@ LDC_TARGETS
         if (!Module::rootModule)
             Module::rootModule = m;
         m->importedFrom = m;
+        PhaseTimer timer("parse", m);
         m->read(0);
         m->parse(global.params.doDocComments);
         m->buildTargetFiles(singleObj);
@@ -898,6 +921,7 @@ LDC_TARGETS
        m = (Module *)modules.data[i];
        if (global.params.verbose)
            printf("importall %s\n", m->toChars());
+       PhaseTimer timer("importall", m);
        m->importAll(0);
     }
     if (global.errors)
@@ -909,13 +933,17 @@ LDC_TARGETS
         m = (Module *)modules.data[i];
         if (global.params.verbose)
             printf("semantic  %s\n", m->toChars());
+        PhaseTimer timer("semantic", m);
         m->semantic();
     }
     if (global.errors)
         fatal();
 
     Module::dprogress = 1;
-    Module::runDeferredSemantic();
+    {
+        PhaseTimer timer("semantic");
+        Module::runDeferredSemantic();
+    }
 
     // Do pass 2 semantic analysis
     for (unsigned i = 0; i < modules.dim; i++)
@@ -923,6 +951,7 @@ LDC_TARGETS
         m = (Module *)modules.data[i];
         if (global.params.verbose)
             printf("semantic2 %s\n", m->toChars());
+        PhaseTimer timer("semantic2", m);
         m->semantic2();
     }
     if (global.errors)
@@ -934,6 +963,7 @@ LDC_TARGETS
         m = (Module *)modules.data[i];
         if (global.params.verbose)
             printf("semantic3 %s\n", m->toChars());
+        PhaseTimer timer("semantic3", m);
         m->semantic3();
     }
     if (global.errors)
@@ -954,9 +984,21 @@ LDC_TARGETS
     if (!global.params.symdebug && willInline())
     {
         global.params.useAvailableExternally = true;
-        Logger::println("Running some extra semantic3's for inlining purposes");
+        IF_LOG Logger::println("Running some extra semantic2's for inlining purposes");
 #endif
         {
+#if IN_LLVM
+            // Pass 3 semantic analysis of imported functions is run on demand
+            // when code generation references them, see mustDefineSymbol().
+            for (unsigned i = 0; i < Module::amodules.dim; i++)
+            {
+                m = (Module *)Module::amodules.data[i];
+                if (global.params.verbose)
+                    printf("semantic2 %s\n", m->toChars());
+                PhaseTimer timer("semantic2", m);
+                m->semantic2();
+            }
+#else
             // Do pass 3 semantic analysis on all imported modules,
             // since otherwise functions in them cannot be inlined
             for (unsigned i = 0; i < Module::amodules.dim; i++)
@@ -967,6 +1009,7 @@ LDC_TARGETS
                 m->semantic2();
                 m->semantic3();
             }
+#endif
             if (global.errors)
                 fatal();
         }
@@ -995,10 +1038,15 @@ LDC_TARGETS
         deps.write();
     }
 
-    // collects llvm modules to be linked if singleobj is passed
-    std::vector<llvm::Module*> llvmModules;
+    // with singleobj, every module is linked into this one as soon as it
+    // has been generated, so only the merged module is kept in memory
+    llvm::Linker* linker = NULL;
     llvm::LLVMContext& context = llvm::getGlobalContext();
 
+    // object files to add to the cache once they have been written
+    initObjectCache(final_args);
+    std::vector<std::pair<std::string, std::string> > newCacheEntries;
+
     // Generate output files
     for (unsigned i = 0; i < modules.dim; i++)
     {
@@ -1007,16 +1055,43 @@ LDC_TARGETS
             printf("code      %s\n", m->toChars());
         if (global.params.obj)
         {
-            llvm::Module* lm = m->genLLVMModule(context, &ir);
-            if (!singleObj)
+            std::string cacheEntry = objectCacheEntry(m);
+            if (!cacheEntry.empty() && restoreCachedObject(cacheEntry, m->objfile->name->str))
             {
-                m->deleteObjFile();
-                writeModule(lm, m->objfile->name->str);
+                if (global.params.verbose)
+                    printf("cached    %s\n", m->toChars());
                 global.params.objfiles->push(m->objfile->name->str);
-                delete lm;
             }
             else
-                llvmModules.push_back(lm);
+            {
+                llvm::Module* lm;
+                {
+                    PhaseTimer timer("codegen", m);
+                    lm = m->genLLVMModule(context, &ir);
+                }
+                if (!singleObj)
+                {
+                    m->deleteObjFile();
+                    writeModuleJob(lm, m->objfile->name->str);
+                    global.params.objfiles->push(m->objfile->name->str);
+                    delete lm;
+                    if (!cacheEntry.empty())
+                        newCacheEntries.push_back(std::make_pair(std::string(m->objfile->name->str), cacheEntry));
+                }
+                else
+                {
+                    if (!linker)
+                    {
+                        char* name = ((Module*)modules.data[0])->toChars();
+                        linker = new llvm::Linker(name, name, context);
+                    }
+                    PhaseTimer timer("link-ir", m);
+                    std::string errormsg;
+                    if (linker->LinkInModule(lm, &errormsg))
+                        error("%s", errormsg.c_str());
+                    delete lm;
+                }
+            }
         }
         if (global.errors)
             m->deleteObjFile();
@@ -1027,28 +1102,36 @@ LDC_TARGETS
         }
     }
 
-    // internal linking for singleobj
-    if (singleObj && llvmModules.size() > 0)
+    // wait for the parallel code generation jobs (-j) to finish
+    waitForModuleJobs();
+
+    if (!global.errors)
+    {
+        for (size_t i = 0; i < newCacheEntries.size(); i++)
+            storeCachedObject(newCacheEntries[i].first.c_str(), newCacheEntries[i].second);
+    }
+
+    // write the linked module for singleobj
+    if (linker)
     {
         Module* m = (Module*)modules.data[0];
-        char* name = m->toChars();
         char* filename = m->objfile->name->str;
 
-        llvm::Linker linker(name, name, context);
+        // objects passed on the command line may reference any symbol
+        bool wholeProgram = linkTimeOpt && global.params.objfiles->dim == 0;
 
-        std::string errormsg;
-        for (int i = 0; i < llvmModules.size(); i++)
+        m->deleteObjFile();
+        if (!global.errors)
         {
-            if(linker.LinkInModule(llvmModules[i], &errormsg))
-                error("%s", errormsg.c_str());
-            delete llvmModules[i];
+            writeModule(linker->getModule(), filename, wholeProgram);
+            global.params.objfiles->push(filename);
         }
-
-        m->deleteObjFile();
-        writeModule(linker.getModule(), filename);
-        global.params.objfiles->push(filename);
+        delete linker;
     }
 
+    if (global.params.verbose)
+        printPeakMemory();
+
     // output json file
     if (global.params.doXGeneration)
         json_generate(&modules);
@@ -1066,26 +1149,29 @@ LDC_TARGETS
     }
     else
     {
+        PhaseTimer timer("link");
         if (global.params.link)
             status = linkObjToBinary(createSharedLib);
         else if (createStaticLib)
             createStaticLibrary();
+    }
 
-        if (global.params.run)
+    printTimeReport();
+
+    if (global.params.objfiles->dim && global.params.run)
+    {
+        if (!status)
         {
-            if (!status)
-            {
-                status = runExecutable();
+            status = runExecutable();
 
-                /* Delete .obj files and .exe file
-                 */
-                for (unsigned i = 0; i < modules.dim; i++)
-                {
-                    m = (Module *)modules.data[i];
-                    m->deleteObjFile();
-                }
-                deleteExecutable();
+            /* Delete .obj files and .exe file
+             */
+            for (unsigned i = 0; i < modules.dim; i++)
+            {
+                m = (Module *)modules.data[i];
+                m->deleteObjFile();
             }
+            deleteExecutable();
         }
     }
 
@@ -0,0 +1,261 @@
+// The object cache lets builds reuse the object files of modules that did
+// not change since a previous build. An object file is stored under a key
+// hashing everything its contents depend on: the module source, the sources
+// of all modules it imports, directly or not, the target, the command line
+// switches (which include the optimizer flags) and the compiler version.
+// The files read by string imports (import("file")) of these modules count
+// as sources too. A module whose object file is found in the cache is not
+// compiled to LLVM IR at all; only the frontend still runs on it.
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+
+#include "mars.h"
+#include "module.h"
+
+#include "gen/logger.h"
+
+#include "driver/cl_options.h"
+#include "driver/objcache.h"
+
+#if _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+typedef unsigned long long CacheKey;
+
+static bool cacheEnabled = false;
+static CacheKey configKey;
+
+// the hashes of the files read so far, as many modules share the same imports
+struct FileHash
+{
+    bool readable;
+    CacheKey hash;
+};
+static std::map<std::string, FileHash> fileHashes;
+
+// 64 bit FNV-1a
+static const CacheKey fnvOffsetBasis = 14695981039346656037ULL;
+static const CacheKey fnvPrime = 1099511628211ULL;
+
+static void hashBytes(CacheKey& h, const char* data, size_t len)
+{
+    for (size_t i = 0; i < len; ++i)
+    {
+        h ^= (unsigned char)data[i];
+        h *= fnvPrime;
+    }
+}
+
+static void hashString(CacheKey& h, const char* str)
+{
+    // include the terminator, so "ab" "c" and "a" "bc" differ
+    hashBytes(h, str, strlen(str) + 1);
+}
+
+static void hashStrings(CacheKey& h, Strings* strs)
+{
+    size_t dim = strs ? strs->dim : 0;
+    hashBytes(h, (const char*)&dim, sizeof(dim));
+    for (size_t i = 0; i < dim; ++i)
+        hashString(h, strs->tdata()[i]);
+}
+
+// Returns false if the file can't be read.
+static bool hashFile(CacheKey& h, const char* filename)
+{
+    std::ifstream in(filename, std::ios::in | std::ios::binary);
+    if (!in)
+        return false;
+
+    char buf[16 * 1024];
+    while (in)
+    {
+        in.read(buf, sizeof(buf));
+        hashBytes(h, buf, in.gcount());
+    }
+    return !in.bad();
+}
+
+// Like hashFile, but reads each file only once per run.
+static bool hashFileCached(CacheKey& h, const std::string& filename)
+{
+    std::map<std::string, FileHash>::iterator it = fileHashes.find(filename);
+    if (it == fileHashes.end())
+    {
+        FileHash fh;
+        fh.hash = fnvOffsetBasis;
+        fh.readable = hashFile(fh.hash, filename.c_str());
+        it = fileHashes.insert(std::make_pair(filename, fh)).first;
+    }
+    if (!it->second.readable)
+        return false;
+    hashBytes(h, (const char*)&it->second.hash, sizeof(CacheKey));
+    return true;
+}
+
+static bool copyFile(const char* from, const char* to)
+{
+    std::ifstream in(from, std::ios::in | std::ios::binary);
+    if (!in)
+        return false;
+    std::ofstream out(to, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!out)
+        return false;
+    out << in.rdbuf();
+    return out.good();
+}
+
+void initObjectCache(const std::vector<const char*>& args)
+{
+    if (opts::objectCacheDir.empty())
+        return;
+
+    if (global.params.singleObj || global.params.output_ll ||
+        global.params.output_bc || global.params.output_s ||
+        !global.params.output_o)
+    {
+        error("-cache can only be used when writing one object file per module");
+        fatal();
+    }
+
+    llvm::sys::Path dir(opts::objectCacheDir);
+    if (!llvm::sys::fs::exists(dir.str()))
+    {
+        std::string errstr;
+        dir.createDirectoryOnDisk(true, &errstr);
+        if (!errstr.empty())
+        {
+            error("failed to create object cache directory: %s\n%s", dir.c_str(), errstr.c_str());
+            fatal();
+        }
+    }
+
+    // A cached object file must not depend on which other modules are
+    // compiled along with it.
+    global.params.templatesOnce = false;
+
+    configKey = fnvOffsetBasis;
+    hashString(configKey, global.ldc_version);
+    hashString(configKey, global.version);
+    hashString(configKey, global.llvm_version);
+    hashString(configKey, global.params.targetTriple);
+
+    // Hash all arguments except argv[0], the source files and the switches
+    // that don't affect code generation. The values of switches spelled as
+    // separate arguments, like "-mcpu atom", don't start with '-' either.
+    std::set<std::string> sourceFiles(opts::fileList.begin(), opts::fileList.end());
+    for (size_t i = 1; i < args.size(); ++i)
+    {
+        const char* arg = args[i];
+        const char* name = arg;
+        while (*name == '-')
+            ++name;
+        if (strcmp(name, "cache") == 0)
+        {
+            ++i;    // skip the directory too
+            continue;
+        }
+        if (sourceFiles.count(arg) ||
+            strncmp(name, "cache=", 6) == 0 ||
+            strncmp(arg, "-j", 2) == 0)
+            continue;
+        hashString(configKey, arg);
+    }
+
+    // also hash the version and debug identifiers as parsed, no matter how
+    // they were spelled on the command line
+    hashBytes(configKey, (const char*)&global.params.versionlevel, sizeof(unsigned));
+    hashStrings(configKey, global.params.versionids);
+    hashBytes(configKey, (const char*)&global.params.debuglevel, sizeof(unsigned));
+    hashStrings(configKey, global.params.debugids);
+
+    cacheEnabled = true;
+}
+
+static void collectImports(Module* m, std::set<Module*>& seen)
+{
+    if (!seen.insert(m).second)
+        return;
+    for (size_t i = 0; i < m->aimports.dim; i++)
+        collectImports(m->aimports.tdata()[i], seen);
+}
+
+std::string objectCacheEntry(Module* m)
+{
+    if (!cacheEnabled)
+        return std::string();
+
+    CacheKey key = configKey;
+    hashString(key, m->toPrettyChars());
+
+    // hash the sources in name order, the order of the module pointers
+    // differs between runs
+    std::set<Module*> imports;
+    collectImports(m, imports);
+    std::set<std::string> files;
+    for (std::set<Module*>::iterator it = imports.begin(); it != imports.end(); ++it)
+    {
+        Module* im = *it;
+        files.insert(im->srcfile->name->str);
+        for (size_t i = 0; i < im->stringImports.dim; i++)
+            files.insert(im->stringImports.tdata()[i]);
+    }
+
+    for (std::set<std::string>::iterator it = files.begin(); it != files.end(); ++it)
+    {
+        hashString(key, it->c_str());
+        if (!hashFileCached(key, *it))
+        {
+            IF_LOG Logger::println("Not caching %s, cannot read %s", m->toChars(), it->c_str());
+            return std::string();
+        }
+    }
+
+    std::ostringstream entry;
+    entry << std::hex << key << '.' << global.obj_ext;
+    llvm::sys::Path path(opts::objectCacheDir);
+    path.appendComponent(entry.str());
+    return path.str();
+}
+
+bool restoreCachedObject(const std::string& entry, const char* objfile)
+{
+    if (!llvm::sys::fs::exists(entry))
+        return false;
+
+    if (!copyFile(entry.c_str(), objfile))
+    {
+        IF_LOG Logger::println("Failed to copy cached object %s", entry.c_str());
+        remove(objfile);
+        return false;
+    }
+    return true;
+}
+
+void storeCachedObject(const char* objfile, const std::string& entry)
+{
+    // write to a temporary first, so concurrent builds never see a
+    // partially written cache entry
+    std::ostringstream tmp;
+    tmp << entry << ".tmp" << getpid();
+    std::string tmpname = tmp.str();
+
+    if (!copyFile(objfile, tmpname.c_str()) ||
+        rename(tmpname.c_str(), entry.c_str()) != 0)
+    {
+        IF_LOG Logger::println("Failed to store %s in the object cache", objfile);
+        remove(tmpname.c_str());
+    }
+}
@@ -0,0 +1,23 @@
+#ifndef LDC_DRIVER_OBJCACHE_H
+#define LDC_DRIVER_OBJCACHE_H
+
+#include <string>
+#include <vector>
+
+struct Module;
+
+// Sets up the object cache if -cache was passed. args are the command line
+// arguments; all but the source files are part of every cache key.
+void initObjectCache(const std::vector<const char*>& args);
+
+// Returns the cache entry for the object file of m, or an empty string if
+// the cache is disabled.
+std::string objectCacheEntry(Module* m);
+
+// Copies the cached object file to objfile. Returns false on a cache miss.
+bool restoreCachedObject(const std::string& entry, const char* objfile);
+
+// Stores objfile in the cache.
+void storeCachedObject(const char* objfile, const std::string& entry);
+
+#endif
@@ -8,6 +8,7 @@
 // See the included readme.txt for details.
 
 #include <cstddef>
+#include <cstring>
 #include <fstream>
 
 #include "llvm/Analysis/Verifier.h"
@@ -22,6 +23,18 @@
 #include "gen/irstate.h"
 #include "gen/logger.h"
 #include "gen/optimizer.h"
+#include "gen/timereport.h"
+
+#include "driver/cl_options.h"
+
+#if POSIX
+#include <map>
+#include <sys/types.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
 
 
 // fwd decl
@@ -30,26 +43,34 @@ void emit_file(llvm::TargetMachine &Target, llvm::Module& m, llvm::raw_fd_ostrea
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
-void writeModule(llvm::Module* m, std::string filename)
+void writeModule(llvm::Module* m, std::string filename, bool wholeProgram)
 {
-    // run optimizer
-    bool reverify = ldc_optimize_module(m);
-
-    // verify the llvm
-    if (!global.params.noVerify && reverify) {
-        std::string verifyErr;
-        Logger::println("Verifying module... again...");
-        LOG_SCOPE;
-        if (llvm::verifyModule(*m,llvm::ReturnStatusAction,&verifyErr))
-        {
-            error("%s", verifyErr.c_str());
-            fatal();
-        }
-        else {
-            Logger::println("Verification passed!");
+    const char* name = m->getModuleIdentifier().c_str();
+
+    {
+        PhaseTimer timer("optimize", name);
+
+        // run optimizer
+        bool reverify = ldc_optimize_module(m, wholeProgram);
+
+        // verify the llvm
+        if (!global.params.noVerify && reverify) {
+            std::string verifyErr;
+            IF_LOG Logger::println("Verifying module... again...");
+            LOG_SCOPE;
+            if (llvm::verifyModule(*m,llvm::ReturnStatusAction,&verifyErr))
+            {
+                error("%s", verifyErr.c_str());
+                fatal();
+            }
+            else {
+                IF_LOG Logger::println("Verification passed!");
+            }
         }
     }
 
+    PhaseTimer timer("emit", name);
+
     // eventually do our own path stuff, dmd's is a bit strange.
     typedef llvm::sys::Path LLPath;
 
@@ -58,7 +79,7 @@ void writeModule(llvm::Module* m, std::string filename)
         LLPath bcpath = LLPath(filename);
         bcpath.eraseSuffix();
         bcpath.appendSuffix(std::string(global.bc_ext));
-        Logger::println("Writing LLVM bitcode to: %s\n", bcpath.c_str());
+        IF_LOG Logger::println("Writing LLVM bitcode to: %s\n", bcpath.c_str());
         std::string errinfo;
         llvm::raw_fd_ostream bos(bcpath.c_str(), errinfo, llvm::raw_fd_ostream::F_Binary);
         if (bos.has_error())
@@ -74,7 +95,7 @@ void writeModule(llvm::Module* m, std::string filename)
         LLPath llpath = LLPath(filename);
         llpath.eraseSuffix();
         llpath.appendSuffix(std::string(global.ll_ext));
-        Logger::println("Writing LLVM asm to: %s\n", llpath.c_str());
+        IF_LOG Logger::println("Writing LLVM asm to: %s\n", llpath.c_str());
         std::string errinfo;
         llvm::raw_fd_ostream aos(llpath.c_str(), errinfo);
         if (aos.has_error())
@@ -90,7 +111,7 @@ void writeModule(llvm::Module* m, std::string filename)
         LLPath spath = LLPath(filename);
         spath.eraseSuffix();
         spath.appendSuffix(std::string(global.s_ext));
-        Logger::println("Writing native asm to: %s\n", spath.c_str());
+        IF_LOG Logger::println("Writing native asm to: %s\n", spath.c_str());
         std::string err;
         {
             llvm::raw_fd_ostream out(spath.c_str(), err);
@@ -108,7 +129,7 @@ void writeModule(llvm::Module* m, std::string filename)
 
     if (global.params.output_o) {
         LLPath objpath = LLPath(filename);
-        Logger::println("Writing object file to: %s\n", objpath.c_str());
+        IF_LOG Logger::println("Writing object file to: %s\n", objpath.c_str());
         std::string err;
         {
             llvm::raw_fd_ostream out(objpath.c_str(), err, llvm::raw_fd_ostream::F_Binary);
@@ -127,6 +148,104 @@ void writeModule(llvm::Module* m, std::string filename)
 
 /* ================================================================== */
 
+#if POSIX
+// The LLVM context, the target machine and the frontend state are not
+// thread-safe, so parallel jobs are run in forked worker processes instead of
+// threads. Every worker gets a copy-on-write snapshot of the finished module
+// and only has to run the optimizer and the code generator on it.
+struct ModuleJob
+{
+    std::string filename;
+    std::string module;
+    double started;
+};
+static std::map<pid_t, ModuleJob> pendingJobs;
+
+static double seconds(const timeval& t)
+{
+    return t.tv_sec + t.tv_usec / 1000000.0;
+}
+
+static void waitForModuleJob()
+{
+    int status;
+    struct rusage usage;
+    pid_t pid = wait4(-1, &status, 0, &usage);
+    if (pid < 0)
+    {
+        if (errno == EINTR)
+            return;
+        error("waiting for code generation jobs failed: %s", strerror(errno));
+        fatal();
+    }
+
+    std::map<pid_t, ModuleJob>::iterator it = pendingJobs.find(pid);
+    if (it == pendingJobs.end())
+        return;
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+        error("code generation for '%s' failed", it->second.filename.c_str());
+
+    // The times the worker measured itself are lost with it. The wall time
+    // seen from here also includes the time until the worker was reaped.
+#if __APPLE__
+    size_t peakRSS = usage.ru_maxrss;
+#else
+    size_t peakRSS = (size_t)usage.ru_maxrss * 1024;
+#endif
+    addPhaseTime("optimize+emit", it->second.module.c_str(), wallTime() - it->second.started,
+        seconds(usage.ru_utime) + seconds(usage.ru_stime), peakRSS);
+    pendingJobs.erase(it);
+}
+#endif
+
+void writeModuleJob(llvm::Module* m, std::string filename)
+{
+#if POSIX
+    if (opts::numJobs > 1)
+    {
+        while (pendingJobs.size() >= opts::numJobs)
+            waitForModuleJob();
+
+        // don't let the child flush output buffered by the parent again
+        fflush(stdout);
+        fflush(stderr);
+
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            writeModule(m, filename);
+            fflush(stdout);
+            fflush(stderr);
+            _exit(global.errors ? EXIT_FAILURE : EXIT_SUCCESS);
+        }
+        else if (pid > 0)
+        {
+            IF_LOG Logger::println("Started job %d for: %s", (int)pid, filename.c_str());
+            ModuleJob& job = pendingJobs[pid];
+            job.filename = filename;
+            job.module = m->getModuleIdentifier();
+            job.started = wallTime();
+            return;
+        }
+
+        // fork failed, just do the work ourselves
+        IF_LOG Logger::println("Could not fork, writing module in-process");
+    }
+#endif
+    writeModule(m, filename);
+}
+
+void waitForModuleJobs()
+{
+#if POSIX
+    while (!pendingJobs.empty())
+        waitForModuleJob();
+#endif
+}
+
+/* ================================================================== */
+
 // based on llc code, University of Illinois Open Source License
 void emit_file(llvm::TargetMachine &Target, llvm::Module& m, llvm::raw_fd_ostream& out,
                llvm::TargetMachine::CodeGenFileType fileType)
@@ -1,6 +1,14 @@
 #ifndef LDC_GEN_TOOBJ_H
 #define LDC_GEN_TOOBJ_H
 
-void writeModule(llvm::Module* m, std::string filename);
+// wholeProgram is passed on to ldc_optimize_module.
+void writeModule(llvm::Module* m, std::string filename, bool wholeProgram = false);
+
+// Like writeModule, but with -j N the optimization and emission are run in a
+// background worker. The caller may delete m as soon as this returns.
+void writeModuleJob(llvm::Module* m, std::string filename);
+
+// Blocks until all workers started by writeModuleJob have finished.
+void waitForModuleJobs();
 
 #endif
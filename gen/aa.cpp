@@ -4,6 +4,7 @@
 #include "module.h"
 #include "declaration.h"
 #include "aggregate.h"
+#include "expression.h"
 
 #include "gen/aa.h"
 #include "gen/runtime.h"
@@ -35,6 +36,193 @@ static LLValue* to_keyti(DValue* key)
 
 /////////////////////////////////////////////////////////////////////////////////////
 
+#if DMDV2
+
+// Lookups with integral, pointer and string keys first probe the hash table
+// inline, so the TypeInfo getHash/compare calls are only made by the runtime
+// on a miss. This relies on the layout of the runtime implementation (aaA.d):
+//
+//   struct BB  { aaA*[] b; size_t nodes; TypeInfo keyti; aaA*[4] binit; }
+//   struct aaA { aaA* next; hash_t hash; /* key */ /* value */ }
+//
+// An AA value is a BB*, the key directly follows the aaA header, and the
+// value follows the key, aligned as in aligntsize(). The hash computed here
+// mirrors TypeInfo.getHash for the key type; should it ever differ, the
+// probe simply misses and the runtime call finds the element.
+
+// struct BB { aaA*[] b; ... }
+static LLType* getAABucketsType()
+{
+    return LLStructType::get(gIR->context(), DtoSize_t(), getPtrToType(getVoidPtrType()), NULL);
+}
+
+// struct aaA { aaA* next; hash_t hash; }
+static LLType* getAANodeType()
+{
+    return LLStructType::get(gIR->context(), getVoidPtrType(), DtoSize_t(), NULL);
+}
+
+// returns the offset of the value in a node, see aligntsize() in the runtime
+static size_t getAAValueOffset(Type* keytype)
+{
+    size_t keysize = getTypePaddedSize(DtoType(keytype));
+    size_t align = global.params.is64bit ? 16 : PTRSIZE;
+    return getTypePaddedSize(getAANodeType()) + ((keysize + align - 1) & ~(align - 1));
+}
+
+static bool isInlineAAKey(Type* keytype, DValue* key)
+{
+    keytype = keytype->toBasetype();
+    if (key->getType()->toBasetype()->ty != keytype->ty)
+        return false;
+    if (keytype->isintegral())
+        return keytype->size() <= 8;
+    if (keytype->ty == Tpointer)
+        return true;
+    if (keytype->ty == Tarray)
+        return keytype->nextOf()->toBasetype()->ty == Tchar;
+    return false;
+}
+
+// returns the hash of key as a size_t, see TypeInfo.getHash
+static LLValue* DtoAAKeyHash(Type* keytype, DValue* key)
+{
+    keytype = keytype->toBasetype();
+    LLType* hashTy = DtoSize_t();
+    LLType* int32Ty = LLType::getInt32Ty(gIR->context());
+
+    if (keytype->ty == Tarray)
+    {
+        // foreach (char c; s) hash = hash * 11 + c;
+        LLValue* len = DtoArrayLen(key);
+        LLValue* ptr = DtoArrayPtr(key);
+
+        llvm::BasicBlock* oldend = gIR->scopeend();
+        llvm::BasicBlock* entrybb = gIR->scopebb();
+        llvm::BasicBlock* condbb = llvm::BasicBlock::Create(gIR->context(), "aa.hashcond", gIR->topfunc(), oldend);
+        llvm::BasicBlock* bodybb = llvm::BasicBlock::Create(gIR->context(), "aa.hashbody", gIR->topfunc(), oldend);
+        llvm::BasicBlock* endbb = llvm::BasicBlock::Create(gIR->context(), "aa.hashend", gIR->topfunc(), oldend);
+        llvm::BranchInst::Create(condbb, entrybb);
+
+        gIR->scope() = IRScope(condbb, bodybb);
+        llvm::PHINode* idx = gIR->ir->CreatePHI(hashTy, 2, "aa.hashidx");
+        llvm::PHINode* hash = gIR->ir->CreatePHI(hashTy, 2, "aa.hash");
+        idx->addIncoming(DtoConstSize_t(0), entrybb);
+        hash->addIncoming(DtoConstSize_t(0), entrybb);
+        LLValue* cond = gIR->ir->CreateICmpULT(idx, len, "tmp");
+        gIR->ir->CreateCondBr(cond, bodybb, endbb);
+
+        gIR->scope() = IRScope(bodybb, endbb);
+        LLValue* c = DtoLoad(DtoGEP1(ptr, idx));
+        c = gIR->ir->CreateZExt(c, hashTy, "tmp");
+        LLValue* newhash = gIR->ir->CreateAdd(gIR->ir->CreateMul(hash, DtoConstSize_t(11), "tmp"), c, "tmp");
+        LLValue* newidx = gIR->ir->CreateAdd(idx, DtoConstSize_t(1), "tmp");
+        idx->addIncoming(newidx, gIR->scopebb());
+        hash->addIncoming(newhash, gIR->scopebb());
+        gIR->ir->CreateBr(condbb);
+
+        gIR->scope() = IRScope(endbb, oldend);
+        return hash;
+    }
+
+    LLValue* val = key->getRVal();
+    if (keytype->ty == Tpointer)
+    {
+        val = gIR->ir->CreatePtrToInt(val, hashTy, "tmp");
+        val = gIR->ir->CreateTrunc(val, int32Ty, "tmp");
+        return gIR->ir->CreateZExt(val, hashTy, "tmp");
+    }
+
+    if (keytype->size() == 8)
+    {
+        // *cast(uint *)p + (cast(uint *)p)[1]
+        LLValue* lo = gIR->ir->CreateTrunc(val, int32Ty, "tmp");
+        LLValue* hi = gIR->ir->CreateLShr(val, LLConstantInt::get(val->getType(), 32), "tmp");
+        hi = gIR->ir->CreateTrunc(hi, int32Ty, "tmp");
+        return gIR->ir->CreateZExt(gIR->ir->CreateAdd(lo, hi, "tmp"), hashTy, "tmp");
+    }
+
+    if (keytype->ty == Tint8 || keytype->ty == Tint16)
+        return gIR->ir->CreateSExt(val, hashTy, "tmp");
+    return gIR->ir->CreateZExt(val, hashTy, "tmp");
+}
+
+// emits an inline lookup of key in the AA aaval (a BB*). Returns the value
+// pointer in the current block on a hit and branches to missbb otherwise.
+static LLValue* DtoAAProbe(LLValue* aaval, Type* keytype, DValue* key, llvm::BasicBlock* missbb)
+{
+    keytype = keytype->toBasetype();
+    llvm::BasicBlock* oldend = gIR->scopeend();
+    LLType* voidPtrTy = getVoidPtrType();
+    LLType* bbTy = getAABucketsType();
+    LLType* nodeTy = getAANodeType();
+
+    // null AA
+    llvm::BasicBlock* bucketbb = llvm::BasicBlock::Create(gIR->context(), "aa.bucket", gIR->topfunc(), oldend);
+    aaval = DtoBitCast(aaval, voidPtrTy);
+    LLValue* isnull = gIR->ir->CreateICmpEQ(aaval, getNullPtr(voidPtrTy), "tmp");
+    gIR->ir->CreateCondBr(isnull, missbb, bucketbb);
+
+    // hash the key and find the bucket
+    gIR->scope() = IRScope(bucketbb, oldend);
+    LLValue* bb = DtoBitCast(aaval, getPtrToType(bbTy));
+    LLValue* nbuckets = DtoLoad(DtoGEPi(bb, 0, 0));
+    LLValue* buckets = DtoLoad(DtoGEPi(bb, 0, 1));
+    LLValue* hash = DtoAAKeyHash(keytype, key);
+    LLValue* first = DtoLoad(DtoGEP1(buckets, gIR->ir->CreateURem(hash, nbuckets, "tmp")));
+    llvm::BasicBlock* entrybb = gIR->scopebb();
+
+    llvm::BasicBlock* chainbb = llvm::BasicBlock::Create(gIR->context(), "aa.chain", gIR->topfunc(), oldend);
+    llvm::BasicBlock* hashbb = llvm::BasicBlock::Create(gIR->context(), "aa.hashcmp", gIR->topfunc(), oldend);
+    llvm::BasicBlock* keybb = llvm::BasicBlock::Create(gIR->context(), "aa.keycmp", gIR->topfunc(), oldend);
+    llvm::BasicBlock* nextbb = llvm::BasicBlock::Create(gIR->context(), "aa.next", gIR->topfunc(), oldend);
+    llvm::BasicBlock* hitbb = llvm::BasicBlock::Create(gIR->context(), "aa.hit", gIR->topfunc(), oldend);
+    gIR->ir->CreateBr(chainbb);
+
+    // walk the chain of the bucket
+    gIR->scope() = IRScope(chainbb, hashbb);
+    llvm::PHINode* node = gIR->ir->CreatePHI(voidPtrTy, 2, "aa.node");
+    node->addIncoming(first, entrybb);
+    isnull = gIR->ir->CreateICmpEQ(node, getNullPtr(voidPtrTy), "tmp");
+    gIR->ir->CreateCondBr(isnull, missbb, hashbb);
+
+    gIR->scope() = IRScope(hashbb, keybb);
+    LLValue* header = DtoBitCast(node, getPtrToType(nodeTy));
+    LLValue* cond = gIR->ir->CreateICmpEQ(DtoLoad(DtoGEPi(header, 0, 1)), hash, "tmp");
+    gIR->ir->CreateCondBr(cond, keybb, nextbb);
+
+    // compare the keys
+    gIR->scope() = IRScope(keybb, nextbb);
+    LLValue* nodekey = DtoBitCast(DtoGEPi1(header, 1), getPtrToType(DtoType(keytype)));
+    if (keytype->ty == Tarray)
+    {
+        llvm::BasicBlock* memcmpbb = llvm::BasicBlock::Create(gIR->context(), "aa.memcmp", gIR->topfunc(), oldend);
+        LLValue* len = DtoArrayLen(key);
+        cond = gIR->ir->CreateICmpEQ(DtoLoad(DtoGEPi(nodekey, 0, 0)), len, "tmp");
+        gIR->ir->CreateCondBr(cond, memcmpbb, nextbb);
+
+        gIR->scope() = IRScope(memcmpbb, nextbb);
+        LLValue* cmp = DtoMemCmp(DtoLoad(DtoGEPi(nodekey, 0, 1)), DtoArrayPtr(key), len);
+        cond = gIR->ir->CreateICmpEQ(cmp, DtoConstInt(0), "tmp");
+    }
+    else
+    {
+        cond = gIR->ir->CreateICmpEQ(DtoLoad(nodekey), key->getRVal(), "tmp");
+    }
+    gIR->ir->CreateCondBr(cond, hitbb, nextbb);
+
+    gIR->scope() = IRScope(nextbb, hitbb);
+    node->addIncoming(DtoLoad(DtoGEPi(header, 0, 0)), nextbb);
+    gIR->ir->CreateBr(chainbb);
+
+    gIR->scope() = IRScope(hitbb, oldend);
+    return DtoGEPi1(node, getAAValueOffset(keytype), "aa.value");
+}
+
+#endif // DMDV2
+
+/////////////////////////////////////////////////////////////////////////////////////
+
 DValue* DtoAAIndex(Loc& loc, Type* type, DValue* aa, DValue* key, bool lvalue)
 {
     // D1:
@@ -73,6 +261,24 @@ DValue* DtoAAIndex(Loc& loc, Type* type, DValue* aa, DValue* key, bool lvalue)
     LLValue* pkey = makeLValue(loc, key);
     pkey = DtoBitCast(pkey, funcTy->getParamType(lvalue ? 3 : 2));
 
+#if DMDV2
+    // probe inline first, only call the runtime on a miss
+    llvm::BasicBlock* oldend = gIR->scopeend();
+    llvm::BasicBlock* endbb = NULL;
+    llvm::BasicBlock* hitbb = NULL;
+    LLValue* hitret = NULL;
+    Type* keytype = ((TypeAArray*)aa->type->toBasetype())->index;
+    if (isInlineAAKey(keytype, key)) {
+        llvm::BasicBlock* missbb = llvm::BasicBlock::Create(gIR->context(), "aa.miss", gIR->topfunc(), oldend);
+        endbb = llvm::BasicBlock::Create(gIR->context(), "aa.end", gIR->topfunc(), oldend);
+        LLValue* probeaa = lvalue ? DtoLoad(aa->getLVal()) : aa->getRVal();
+        hitret = DtoAAProbe(probeaa, keytype, key, missbb);
+        hitbb = gIR->scopebb();
+        gIR->ir->CreateBr(endbb);
+        gIR->scope() = IRScope(missbb, endbb);
+    }
+#endif
+
     // call runtime
     LLValue* ret;
     if (lvalue) {
@@ -84,6 +290,18 @@ DValue* DtoAAIndex(Loc& loc, Type* type, DValue* aa, DValue* key, bool lvalue)
         ret = gIR->CreateCallOrInvoke3(func, aaval, keyti, pkey, "aa.index").getInstruction();
     }
 
+#if DMDV2
+    if (endbb) {
+        llvm::BasicBlock* missbb = gIR->scopebb();
+        gIR->ir->CreateBr(endbb);
+        gIR->scope() = IRScope(endbb, oldend);
+        llvm::PHINode* phi = gIR->ir->CreatePHI(ret->getType(), 2, "aa.index");
+        phi->addIncoming(hitret, hitbb);
+        phi->addIncoming(ret, missbb);
+        ret = phi;
+    }
+#endif
+
     // cast return value
     LLType* targettype = getPtrToType(DtoType(type));
     if (ret->getType() != targettype)
@@ -161,8 +379,8 @@ DValue* DtoAAIn(Loc& loc, Type* type, DValue* aa, DValue* key)
     LLValue* aaval = aa->getRVal();
     if (Logger::enabled())
     {
-        Logger::cout() << "aaval: " << *aaval << '\n';
-        Logger::cout() << "totype: " << *funcTy->getParamType(0) << '\n';
+        IF_LOG Logger::cout() << "aaval: " << *aaval << '\n';
+        IF_LOG Logger::cout() << "totype: " << *funcTy->getParamType(0) << '\n';
     }
     aaval = DtoBitCast(aaval, funcTy->getParamType(0));
 
@@ -178,9 +396,38 @@ DValue* DtoAAIn(Loc& loc, Type* type, DValue* aa, DValue* key)
     LLValue* pkey = makeLValue(loc, key);
     pkey = DtoBitCast(pkey, getVoidPtrType());
 
+#if DMDV2
+    // probe inline first, only call the runtime on a miss
+    llvm::BasicBlock* oldend = gIR->scopeend();
+    llvm::BasicBlock* endbb = NULL;
+    llvm::BasicBlock* hitbb = NULL;
+    LLValue* hitret = NULL;
+    Type* keytype = ((TypeAArray*)aa->type->toBasetype())->index;
+    if (isInlineAAKey(keytype, key)) {
+        llvm::BasicBlock* missbb = llvm::BasicBlock::Create(gIR->context(), "aa.miss", gIR->topfunc(), oldend);
+        endbb = llvm::BasicBlock::Create(gIR->context(), "aa.end", gIR->topfunc(), oldend);
+        hitret = DtoAAProbe(aaval, keytype, key, missbb);
+        hitbb = gIR->scopebb();
+        gIR->ir->CreateBr(endbb);
+        gIR->scope() = IRScope(missbb, endbb);
+    }
+#endif
+
     // call runtime
     LLValue* ret = gIR->CreateCallOrInvoke3(func, aaval, keyti, pkey, "aa.in").getInstruction();
 
+#if DMDV2
+    if (endbb) {
+        llvm::BasicBlock* missbb = gIR->scopebb();
+        gIR->ir->CreateBr(endbb);
+        gIR->scope() = IRScope(endbb, oldend);
+        llvm::PHINode* phi = gIR->ir->CreatePHI(ret->getType(), 2, "aa.in");
+        phi->addIncoming(hitret, hitbb);
+        phi->addIncoming(ret, missbb);
+        ret = phi;
+    }
+#endif
+
     // cast return value
     LLType* targettype = DtoType(type);
     if (ret->getType() != targettype)
@@ -216,8 +463,8 @@ DValue *DtoAARemove(Loc& loc, DValue* aa, DValue* key)
     LLValue* aaval = aa->getRVal();
     if (Logger::enabled())
     {
-        Logger::cout() << "aaval: " << *aaval << '\n';
-        Logger::cout() << "totype: " << *funcTy->getParamType(0) << '\n';
+        IF_LOG Logger::cout() << "aaval: " << *aaval << '\n';
+        IF_LOG Logger::cout() << "totype: " << *funcTy->getParamType(0) << '\n';
     }
     aaval = DtoBitCast(aaval, funcTy->getParamType(0));
 
@@ -278,4 +525,121 @@ LLValue* DtoAAEquals(Loc& loc, TOK op, DValue* l, DValue* r)
     return res;
 }
 
+/////////////////////////////////////////////////////////////////////////////////////
+
+#if DMDV2
+
+DValue* DtoForeachAA(Loc& loc, DFuncValue* fnval, Expressions* arguments)
+{
+    // int _aaApply(AA aa, size_t keysize, dg_t dg)
+    // int _aaApply2(AA aa, size_t keysize, dg2_t dg)
+    FuncDeclaration* fdapply = fnval->func;
+    const char* name = fdapply->ident->toChars();
+    if (fdapply->linkage != LINKc || !arguments || arguments->dim != 3)
+        return NULL;
+    size_t nparams;
+    if (strcmp(name, "_aaApply") == 0)
+        nparams = 1;
+    else if (strcmp(name, "_aaApply2") == 0)
+        nparams = 2;
+    else
+        return NULL;
+
+    // the loop body, see ForeachStatement::semantic
+    Expression* aggr = (Expression*)arguments->data[0];
+    if (aggr->type->toBasetype()->ty != Taarray)
+        return NULL;
+    Expression* body = (Expression*)arguments->data[2];
+    if (body->op == TOKcast)
+        body = ((CastExp*)body)->e1;
+    if (body->op != TOKfunction)
+        return NULL;
+    Parameters* params = ((TypeFunction*)body->type->toBasetype()->nextOf())->parameters;
+    if (Parameter::dim(params) != nparams)
+        return NULL;
+    for (size_t i = 0; i < nparams; i++)
+    {
+        if (!(Parameter::getNth(params, i)->storageClass & STCref))
+            return NULL;
+    }
+
+    IF_LOG Logger::println("Iterating over the AA inline for %s", name);
+    LOG_SCOPE;
+
+    Type* keytype = ((TypeAArray*)aggr->type->toBasetype())->index;
+    LLType* sizeTy = DtoSize_t();
+    LLType* i32Ty = LLType::getInt32Ty(gIR->context());
+    LLType* voidPtrTy = getVoidPtrType();
+
+    LLValue* aaval = DtoBitCast(aggr->toElem(gIR)->getRVal(), voidPtrTy);
+    DValue* dg = body->toElem(gIR);
+
+    LLValue* idx = DtoRawAlloca(sizeTy, 0, "aa.idx");
+    LLValue* node = DtoRawAlloca(voidPtrTy, 0, "aa.node");
+    LLValue* result = DtoRawAlloca(i32Ty, 0, "aa.result");
+    DtoStore(LLConstantInt::get(i32Ty, 0), result);
+
+    llvm::BasicBlock* oldend = gIR->scopeend();
+    llvm::BasicBlock* initbb = llvm::BasicBlock::Create(gIR->context(), "aa.init", gIR->topfunc(), oldend);
+    llvm::BasicBlock* bucketcondbb = llvm::BasicBlock::Create(gIR->context(), "aa.bucketcond", gIR->topfunc(), oldend);
+    llvm::BasicBlock* bucketbb = llvm::BasicBlock::Create(gIR->context(), "aa.bucket", gIR->topfunc(), oldend);
+    llvm::BasicBlock* nodecondbb = llvm::BasicBlock::Create(gIR->context(), "aa.nodecond", gIR->topfunc(), oldend);
+    llvm::BasicBlock* bodybb = llvm::BasicBlock::Create(gIR->context(), "aa.body", gIR->topfunc(), oldend);
+    llvm::BasicBlock* endbb = llvm::BasicBlock::Create(gIR->context(), "aa.end", gIR->topfunc(), oldend);
+
+    // null AA
+    LLValue* isnull = gIR->ir->CreateICmpEQ(aaval, getNullPtr(voidPtrTy), "tmp");
+    gIR->ir->CreateCondBr(isnull, endbb, initbb);
+
+    // the bucket array is only read once, like the runtime does
+    gIR->scope() = IRScope(initbb, bucketcondbb);
+    LLValue* bb = DtoBitCast(aaval, getPtrToType(getAABucketsType()));
+    LLValue* nbuckets = DtoLoad(DtoGEPi(bb, 0, 0));
+    LLValue* buckets = DtoLoad(DtoGEPi(bb, 0, 1));
+    DtoStore(DtoConstSize_t(0), idx);
+    gIR->ir->CreateBr(bucketcondbb);
+
+    // any buckets left?
+    gIR->scope() = IRScope(bucketcondbb, bucketbb);
+    LLValue* i = DtoLoad(idx);
+    gIR->ir->CreateCondBr(gIR->ir->CreateICmpULT(i, nbuckets, "tmp"), bucketbb, endbb);
+
+    gIR->scope() = IRScope(bucketbb, nodecondbb);
+    DtoStore(DtoLoad(DtoGEP1(buckets, i)), node);
+    DtoStore(gIR->ir->CreateAdd(i, DtoConstSize_t(1), "tmp"), idx);
+    gIR->ir->CreateBr(nodecondbb);
+
+    // walk the chain of the bucket
+    gIR->scope() = IRScope(nodecondbb, bodybb);
+    LLValue* cur = DtoLoad(node);
+    isnull = gIR->ir->CreateICmpEQ(cur, getNullPtr(voidPtrTy), "tmp");
+    gIR->ir->CreateCondBr(isnull, bucketcondbb, bodybb);
+
+    // call the loop body with the key and the value of the node, a non-zero
+    // result ends the loop
+    gIR->scope() = IRScope(bodybb, endbb);
+    Expressions* bodyargs = new Expressions;
+    if (nparams == 2)
+    {
+        Parameter* keyparam = Parameter::getNth(params, 0);
+        LLValue* keyptr = DtoGEPi1(cur, getTypePaddedSize(getAANodeType()), "aa.key");
+        keyptr = DtoBitCast(keyptr, getPtrToType(DtoType(keyparam->type)));
+        bodyargs->push(DtoLvalueExp(loc, keyparam->type, keyptr));
+    }
+    Parameter* valparam = Parameter::getNth(params, nparams - 1);
+    LLValue* valptr = DtoGEPi1(cur, getAAValueOffset(keytype), "aa.value");
+    valptr = DtoBitCast(valptr, getPtrToType(DtoType(valparam->type)));
+    bodyargs->push(DtoLvalueExp(loc, valparam->type, valptr));
+
+    LLValue* ret = DtoCallFunction(loc, Type::tint32, dg, bodyargs)->getRVal();
+    DtoStore(ret, result);
+    // the next node is only read after the body ran, like the runtime does
+    LLValue* header = DtoBitCast(cur, getPtrToType(getAANodeType()));
+    DtoStore(DtoLoad(DtoGEPi(header, 0, 0)), node);
+    gIR->ir->CreateCondBr(gIR->ir->CreateICmpEQ(ret, LLConstantInt::get(i32Ty, 0), "tmp"), nodecondbb, endbb);
+
+    gIR->scope() = IRScope(endbb, oldend);
+    return new DImValue(Type::tint32, DtoLoad(result));
+}
 
+#endif // DMDV2
@@ -1,9 +1,18 @@
 #ifndef LDC_GEN_AA_H
 #define LDC_GEN_AA_H
 
+struct DFuncValue;
+
 DValue* DtoAAIndex(Loc& loc, Type* type, DValue* aa, DValue* key, bool lvalue);
 DValue* DtoAAIn(Loc& loc, Type* type, DValue* aa, DValue* key);
 DValue* DtoAARemove(Loc& loc, DValue* aa, DValue* key);
 LLValue* DtoAAEquals(Loc& loc, TOK op, DValue* l, DValue* r);
 
+#if DMDV2
+// Emits a call to _aaApply or _aaApply2, as foreach over an associative array
+// is lowered to, as an inline loop over the buckets calling the body directly.
+// Returns NULL if fnval is not such a function.
+DValue* DtoForeachAA(Loc& loc, DFuncValue* fnval, Expressions* arguments);
+#endif
+
 #endif // LDC_GEN_AA_H
@@ -70,7 +70,7 @@ struct CompositeToInt : ABIRewrite
 {
     LLValue* get(Type* dty, DValue* dv)
     {
-        Logger::println("rewriting integer -> %s", dty->toChars());
+        IF_LOG Logger::println("rewriting integer -> %s", dty->toChars());
         LLValue* mem = DtoAlloca(dty, ".int_to_composite");
         LLValue* v = dv->getRVal();
         DtoStore(v, DtoBitCast(mem, getPtrToType(v->getType())));
@@ -79,14 +79,14 @@ struct CompositeToInt : ABIRewrite
 
     void getL(Type* dty, DValue* dv, llvm::Value* lval)
     {
-        Logger::println("rewriting integer -> %s", dty->toChars());
+        IF_LOG Logger::println("rewriting integer -> %s", dty->toChars());
         LLValue* v = dv->getRVal();
         DtoStore(v, DtoBitCast(lval, getPtrToType(v->getType())));
     }
 
     LLValue* put(Type* dty, DValue* dv)
     {
-        Logger::println("rewriting %s -> integer", dty->toChars());
+        IF_LOG Logger::println("rewriting %s -> integer", dty->toChars());
         LLType* t = LLIntegerType::get(gIR->context(), dty->size() * 8);
         return DtoLoad(DtoBitCast(dv->getRVal(), getPtrToType(t)));
     }
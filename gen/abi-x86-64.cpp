@@ -16,6 +16,11 @@
  * marked with the ByVal attribute to ensure no part of them ends up in
  * registers when only a subset of the desired registers are available.
  *
+ * extern(D) uses the same transformation to pass and return structs and
+ * static arrays of up to 16 bytes in registers, whenever extern(C) would pass
+ * a struct of that layout in registers. Bigger ones are passed byval and
+ * returned via sret.
+ *
  * We don't perform the same transformation for D-specific types that contain
  * multiple parts, such as dynamic arrays and delegates. They're passed as if
  * the parts were passed as separate parameters. This helps make things like
@@ -126,7 +131,19 @@ namespace {
 
         ty = ty->toBasetype();
 
-        if (ty->isintegral() || ty->ty == Tpointer) {
+        if (ty->ty == Tvector) {
+            // Must come first, isintegral() and isfloating() report the
+            // kind of the elements. Treat the vector as 16 bytes of doubles.
+            if (ty->size() != 16) {
+                accum.addField(offset, Memory);
+            } else {
+                accum.addField(offset, Sse);
+                accum.addField(offset+8, Sse);
+            }
+        } else if (ty->ty == Tvoid) {
+            // void[N]: nothing is known about the contents
+            accum.addField(offset, Memory);
+        } else if (ty->isintegral() || ty->ty == Tpointer) {
             accum.addField(offset, Integer);
         } else if (ty->ty == Tfloat80 || ty->ty == Timaginary80) {
             accum.addField(offset, X87);
@@ -166,6 +183,9 @@ namespace {
                 VarDeclaration* field = (VarDeclaration*) fields->data[i];
                 classifyType(accum, field->type, offset + field->offset);
             }
+        } else if (ty->size() % 8 != 0 || (offset != 0 && offset != 8)) {
+            // not one of the pointer-sized types handled below
+            accum.addField(offset, Memory);
         } else {
             if (Logger::enabled())
                 Logger::cout() << "x86-64 ABI: Implicitly handled type: "
@@ -205,7 +225,7 @@ namespace {
         if (keepUnchanged(ty))
             return 0;
 
-        if (ty->ty != Tcomplex32 && ty->ty != Tstruct)
+        if (ty->ty != Tcomplex32 && ty->ty != Tstruct && ty->ty != Tsarray)
             return 0; // Nothing to do,
 
         Classification cl = classify(ty);
@@ -278,6 +298,19 @@ namespace {
         }
         return LLStructType::get(gIR->context(), parts);
     }
+
+    /**
+     * Returns true if extern(D) passes and returns a struct or static array
+     * of this type in registers, see getAbiType().
+     */
+    bool passAggregateInRegs(Type* ty) {
+        ty = ty->toBasetype();
+        if (ty->ty != Tstruct && ty->ty != Tsarray)
+            return false;
+        if (ty->size() > 16 || classify(ty).isMemory)
+            return false;
+        return getAbiType(ty) != 0;
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -407,8 +440,9 @@ bool X86_64TargetABI::returnInArg(TypeFunction* tf) {
         if (tf->isref)
             return false;
 #endif
-        // All non-structs can be returned in registers.
-        return (rt->ty == Tstruct);
+        // All non-structs can be returned in registers, and small structs
+        // as well.
+        return (rt->ty == Tstruct) && !passAggregateInRegs(rt);
     } else {
         if (rt == Type::tvoid || keepUnchanged(rt))
             return false;
@@ -428,8 +462,9 @@ bool X86_64TargetABI::returnInArg(TypeFunction* tf) {
 bool X86_64TargetABI::passByVal(Type* t) {
     t = t->toBasetype();
     if (linkage() == LINKd) {
-        // static arrays are also passed byval
-        return t->ty == Tstruct || t->ty == Tsarray;
+        // structs and static arrays are passed byval, unless they are
+        // small enough for registers
+        return (t->ty == Tstruct || t->ty == Tsarray) && !passAggregateInRegs(t);
     } else {
         // This implements the C calling convention for x86-64.
         // It might not be correct for other calling conventions.
@@ -493,6 +528,10 @@ bool X86_64TargetABI::passByVal(Type* t) {
 // Return type and parameters are passed here (unless they're already in memory)
 // to get the rewrite applied (if necessary).
 void X86_64TargetABI::fixup(IrFuncTyArg& arg) {
+    // C has no static array values, so they are left to LLVM
+    if (arg.type->toBasetype()->ty == Tsarray)
+        return;
+
     LLType* abiTy = getAbiType(arg.type);
 
     if (abiTy && abiTy != arg.ltype) {
@@ -513,9 +552,16 @@ void X86_64TargetABI::rewriteFunctionType(TypeFunction* tf) {
         // complex {re,im} -> {im,re}
         if (rt->iscomplex())
         {
-            Logger::println("Rewriting complex return value");
+            IF_LOG Logger::println("Rewriting complex return value");
             fty.ret->rewrite = &swapComplex;
         }
+        // small structs and static arrays are returned in registers
+        else if (!fty.ret->byref && passAggregateInRegs(rt))
+        {
+            IF_LOG Logger::println("Returning struct/sarray in registers");
+            fty.ret->rewrite = &struct_rewrite;
+            fty.ret->ltype = struct_rewrite.type(fty.ret->type, fty.ret->ltype);
+        }
 
         // IMPLICIT PARAMETERS
 
@@ -525,19 +571,19 @@ void X86_64TargetABI::rewriteFunctionType(TypeFunction* tf) {
         // mark this/nested params inreg
         if (fty.arg_this)
         {
-            Logger::println("Putting 'this' in register");
+            IF_LOG Logger::println("Putting 'this' in register");
             fty.arg_this->attrs = llvm::Attribute::InReg;
             --regcount;
         }
         else if (fty.arg_nest)
         {
-            Logger::println("Putting context ptr in register");
+            IF_LOG Logger::println("Putting context ptr in register");
             fty.arg_nest->attrs = llvm::Attribute::InReg;
             --regcount;
         }
         else if (IrFuncTyArg* sret = fty.arg_sret)
         {
-            Logger::println("Putting sret ptr in register");
+            IF_LOG Logger::println("Putting sret ptr in register");
             // sret and inreg are incompatible, but the ABI requires the
             // sret parameter to be in RDI in this situation...
             sret->attrs = (sret->attrs | llvm::Attribute::InReg)
@@ -545,7 +591,7 @@ void X86_64TargetABI::rewriteFunctionType(TypeFunction* tf) {
             --regcount;
         }
 
-        Logger::println("x86-64 D ABI: Transforming arguments");
+        IF_LOG Logger::println("x86-64 D ABI: Transforming arguments");
         LOG_SCOPE;
 
         for (IrFuncTy::ArgRIter I = fty.args.rbegin(), E = fty.args.rend(); I != E; ++I) {
@@ -557,37 +603,56 @@ void X86_64TargetABI::rewriteFunctionType(TypeFunction* tf) {
             if (ty->isfloating() && sz <= 8)
             {
                if (xmmcount > 0) {
-                   Logger::println("Putting float parameter in register");
+                   IF_LOG Logger::println("Putting float parameter in register");
                    arg.attrs |= llvm::Attribute::InReg;
                    --xmmcount;
                }
             }
+            else if (!arg.byref && passAggregateInRegs(ty) &&
+                     !(regcount > 0 && (sz == 1 || sz == 2 || sz == 4 || sz == 8)))
+            {
+                // Checked before running out of integer registers, as
+                // aggregates of floating point fields use XMM registers.
+                // While integer registers are left, aggregates of 1, 2, 4
+                // or 8 bytes are passed in one of them instead, see below.
+                IF_LOG Logger::println("Putting struct/sarray in registers");
+                arg.rewrite = &struct_rewrite;
+                arg.ltype = struct_rewrite.type(arg.type, arg.ltype);
+
+                Classification cl = classify(ty);
+                for (int i = 0; i < 2; i++) {
+                    if (cl.classes[i] == Integer && regcount > 0)
+                        --regcount;
+                    else if (cl.classes[i] == Sse && xmmcount > 0)
+                        --xmmcount;
+                }
+            }
             else if (regcount == 0)
             {
                 continue;
             }
             else if (arg.byref && !arg.isByVal())
             {
-                Logger::println("Putting byref parameter in register");
+                IF_LOG Logger::println("Putting byref parameter in register");
                 arg.attrs |= llvm::Attribute::InReg;
                 --regcount;
             }
             else if (ty->ty == Tpointer)
             {
-                Logger::println("Putting pointer parameter in register");
+                IF_LOG Logger::println("Putting pointer parameter in register");
                 arg.attrs |= llvm::Attribute::InReg;
                 --regcount;
             }
             else if (ty->isintegral() && sz <= 8)
             {
-                Logger::println("Putting integral parameter in register");
+                IF_LOG Logger::println("Putting integral parameter in register");
                 arg.attrs |= llvm::Attribute::InReg;
                 --regcount;
             }
             else if ((ty->ty == Tstruct || ty->ty == Tsarray) &&
                      (sz == 1 || sz == 2 || sz == 4 || sz == 8))
             {
-                Logger::println("Putting struct/sarray in register");
+                IF_LOG Logger::println("Putting struct/sarray in register");
                 arg.rewrite = &compositeToInt;
                 arg.ltype = compositeToInt.type(arg.type, arg.ltype);
                 arg.byref = false;
@@ -608,13 +673,13 @@ void X86_64TargetABI::rewriteFunctionType(TypeFunction* tf) {
         // TODO: See if this is correct for more than just extern(C).
 
         if (!fty.arg_sret) {
-            Logger::println("x86-64 ABI: Transforming return type");
+            IF_LOG Logger::println("x86-64 ABI: Transforming return type");
             Type* rt = fty.ret->type->toBasetype();
             if (rt != Type::tvoid)
                 fixup(*fty.ret);
         }
 
-        Logger::println("x86-64 ABI: Transforming arguments");
+        IF_LOG Logger::println("x86-64 ABI: Transforming arguments");
         LOG_SCOPE;
 
         for (IrFuncTy::ArgIter I = fty.args.begin(), E = fty.args.end(); I != E; ++I) {
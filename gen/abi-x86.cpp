@@ -105,7 +105,7 @@ struct X86TargetABI : TargetABI
             // complex {re,im} -> {im,re}
             if (rt->iscomplex())
             {
-                Logger::println("Rewriting complex return value");
+                IF_LOG Logger::println("Rewriting complex return value");
                 fty.ret->rewrite = &swapComplex;
             }
 
@@ -114,17 +114,17 @@ struct X86TargetABI : TargetABI
             // mark this/nested params inreg
             if (fty.arg_this)
             {
-                Logger::println("Putting 'this' in register");
+                IF_LOG Logger::println("Putting 'this' in register");
                 fty.arg_this->attrs = llvm::Attribute::InReg;
             }
             else if (fty.arg_nest)
             {
-                Logger::println("Putting context ptr in register");
+                IF_LOG Logger::println("Putting context ptr in register");
                 fty.arg_nest->attrs = llvm::Attribute::InReg;
             }
             else if (IrFuncTyArg* sret = fty.arg_sret)
             {
-                Logger::println("Putting sret ptr in register");
+                IF_LOG Logger::println("Putting sret ptr in register");
                 // sret and inreg are incompatible, but the ABI requires the
                 // sret parameter to be in EAX in this situation...
                 sret->attrs = (sret->attrs | llvm::Attribute::InReg)
@@ -144,7 +144,7 @@ struct X86TargetABI : TargetABI
 
                 if (last->byref && !last->isByVal())
                 {
-                    Logger::println("Putting last (byref) parameter in register");
+                    IF_LOG Logger::println("Putting last (byref) parameter in register");
                     last->attrs |= llvm::Attribute::InReg;
                 }
                 else if (!lastTy->isfloating() && (sz == 1 || sz == 2 || sz == 4)) // right?
@@ -66,7 +66,7 @@ TargetABI * TargetABI::getTarget()
     case ARCHx86_64:
         return getX86_64TargetABI();
     default:
-        Logger::cout() << "WARNING: Unknown ABI, guessing...\n";
+        IF_LOG Logger::cout() << "WARNING: Unknown ABI, guessing...\n";
         return new UnknownTargetABI;
     }
 }
@@ -109,12 +109,12 @@ struct IntrinsicABI : TargetABI
         if (!fty.arg_sret) {
             Type* rt = fty.ret->type->toBasetype();
             if (rt->ty == Tstruct)  {
-                Logger::println("Intrinsic ABI: Transforming return type");
+                IF_LOG Logger::println("Intrinsic ABI: Transforming return type");
                 fixup(*fty.ret);
             }
         }
 
-        Logger::println("Intrinsic ABI: Transforming arguments");
+        IF_LOG Logger::println("Intrinsic ABI: Transforming arguments");
         LOG_SCOPE;
 
         for (IrFuncTy::ArgIter I = fty.args.begin(), E = fty.args.end(); I != E; ++I) {
@@ -6,6 +6,7 @@
 #include "aggregate.h"
 #include "declaration.h"
 #include "init.h"
+#include "expression.h"
 
 #include "gen/irstate.h"
 #include "gen/tollvm.h"
@@ -95,7 +96,7 @@ LLArrayType* DtoStaticArrayType(Type* t)
 
 void DtoSetArrayToNull(LLValue* v)
 {
-    Logger::println("DtoSetArrayToNull");
+    IF_LOG Logger::println("DtoSetArrayToNull");
     LOG_SCOPE;
 
     assert(isaPointer(v));
@@ -108,7 +109,7 @@ void DtoSetArrayToNull(LLValue* v)
 
 void DtoArrayInit(Loc& loc, DValue* array, DValue* value, int op)
 {
-    Logger::println("DtoArrayInit");
+    IF_LOG Logger::println("DtoArrayInit");
     LOG_SCOPE;
 
 #if DMDV2
@@ -203,7 +204,7 @@ bool arrayNeedsPostblit(Type *t)
 // Does array assignment (or initialization) from another array of the same element type.
 void DtoArrayAssign(DValue *array, DValue *value, int op)
 {
-    Logger::println("DtoArrayAssign");
+    IF_LOG Logger::println("DtoArrayAssign");
     LOG_SCOPE;
 
     assert(value && array);
@@ -226,7 +227,7 @@ void DtoArrayAssign(DValue *array, DValue *value, int op)
 // otherwise, does assignment to an array.
 void DtoArraySetAssign(Loc &loc, DValue *array, DValue *value, int op)
 {
-    Logger::println("DtoArraySetAssign");
+    IF_LOG Logger::println("DtoArraySetAssign");
     LOG_SCOPE;
 
     assert(array && value);
@@ -252,7 +253,7 @@ void DtoArraySetAssign(Loc &loc, DValue *array, DValue *value, int op)
 
 void DtoSetArray(DValue* array, LLValue* dim, LLValue* ptr)
 {
-    Logger::println("SetArray");
+    IF_LOG Logger::println("SetArray");
     LLValue *arr = array->getLVal();
     assert(isaStruct(arr->getType()->getContainedType(0)));
     DtoStore(dim, DtoGEPi(arr,0,0));
@@ -342,7 +343,7 @@ LLType* DtoConstArrayInitializerType(ArrayInitializer* arrinit)
 
 LLConstant* DtoConstArrayInitializer(ArrayInitializer* arrinit)
 {
-    Logger::println("DtoConstArrayInitializer: %s | %s", arrinit->toChars(), arrinit->type->toChars());
+    IF_LOG Logger::println("DtoConstArrayInitializer: %s | %s", arrinit->toChars(), arrinit->type->toChars());
     LOG_SCOPE;
 
     assert(arrinit->value.dim == arrinit->index.dim);
@@ -470,7 +471,7 @@ static LLValue* get_slice_ptr(DSliceValue* e, LLValue*& sz)
 
 void DtoArrayCopySlices(DSliceValue* dst, DSliceValue* src)
 {
-    Logger::println("ArrayCopySlices");
+    IF_LOG Logger::println("ArrayCopySlices");
 
     LLValue *sz1,*sz2;
     LLValue* dstarr = get_slice_ptr(dst,sz1);
@@ -489,7 +490,7 @@ void DtoArrayCopySlices(DSliceValue* dst, DSliceValue* src)
 
 void DtoArrayCopyToSlice(DSliceValue* dst, DValue* src)
 {
-    Logger::println("ArrayCopyToSlice");
+    IF_LOG Logger::println("ArrayCopyToSlice");
 
     LLValue* sz1;
     LLValue* dstarr = get_slice_ptr(dst,sz1);
@@ -512,7 +513,7 @@ void DtoArrayCopyToSlice(DSliceValue* dst, DValue* src)
 //////////////////////////////////////////////////////////////////////////////////////////
 void DtoStaticArrayCopy(LLValue* dst, LLValue* src)
 {
-    Logger::println("StaticArrayCopy");
+    IF_LOG Logger::println("StaticArrayCopy");
 
     size_t n = getTypePaddedSize(dst->getType()->getContainedType(0));
     DtoMemCpy(dst, src, DtoConstSize_t(n));
@@ -539,7 +540,7 @@ static bool isInitialized(Type* et) {
     }
     // If it's a typedef with "= void" initializer then don't initialize.
     if (et->ty == Ttypedef) {
-        Logger::println("Typedef: %s", et->toChars());
+        IF_LOG Logger::println("Typedef: %s", et->toChars());
         TypedefDeclaration* tdd = ((TypeTypedef*)et)->sym;
         if (tdd && tdd->init && tdd->init->isVoidInitializer())
             return false;
@@ -567,7 +568,7 @@ static DSliceValue *getSlice(Type *arrayType, LLValue *array)
 //////////////////////////////////////////////////////////////////////////////////////////
 DSliceValue* DtoNewDynArray(Loc& loc, Type* arrayType, DValue* dim, bool defaultInit)
 {
-    Logger::println("DtoNewDynArray : %s", arrayType->toChars());
+    IF_LOG Logger::println("DtoNewDynArray : %s", arrayType->toChars());
     LOG_SCOPE;
 
     // typeinfo arg
@@ -618,7 +619,7 @@ DSliceValue* DtoNewDynArray(Loc& loc, Type* arrayType, DValue* dim, bool default
 //////////////////////////////////////////////////////////////////////////////////////////
 DSliceValue* DtoNewMulDimDynArray(Loc& loc, Type* arrayType, DValue** dims, size_t ndims, bool defaultInit)
 {
-    Logger::println("DtoNewMulDimDynArray : %s", arrayType->toChars());
+    IF_LOG Logger::println("DtoNewMulDimDynArray : %s", arrayType->toChars());
     LOG_SCOPE;
 
     // typeinfo arg
@@ -688,7 +689,7 @@ DSliceValue* DtoNewMulDimDynArray(Loc& loc, Type* arrayType, DValue** dims, size
 //////////////////////////////////////////////////////////////////////////////////////////
 DSliceValue* DtoResizeDynArray(Type* arrayType, DValue* array, LLValue* newdim)
 {
-    Logger::println("DtoResizeDynArray : %s", arrayType->toChars());
+    IF_LOG Logger::println("DtoResizeDynArray : %s", arrayType->toChars());
     LOG_SCOPE;
 
     assert(array);
@@ -736,7 +737,7 @@ DSliceValue* DtoResizeDynArray(Type* arrayType, DValue* array, LLValue* newdim)
 
 void DtoCatAssignElement(Loc& loc, Type* arrayType, DValue* array, Expression* exp)
 {
-    Logger::println("DtoCatAssignElement");
+    IF_LOG Logger::println("DtoCatAssignElement");
     LOG_SCOPE;
 
     assert(array);
@@ -766,7 +767,7 @@ void DtoCatAssignElement(Loc& loc, Type* arrayType, DValue* array, Expression* e
 
 void DtoCatAssignElement(Loc& loc, Type* arrayType, DValue* array, Expression* exp)
 {
-    Logger::println("DtoCatAssignElement");
+    IF_LOG Logger::println("DtoCatAssignElement");
     LOG_SCOPE;
 
     assert(array);
@@ -790,7 +791,7 @@ void DtoCatAssignElement(Loc& loc, Type* arrayType, DValue* array, Expression* e
 
 DSliceValue* DtoCatAssignArray(DValue* arr, Expression* exp)
 {
-    Logger::println("DtoCatAssignArray");
+    IF_LOG Logger::println("DtoCatAssignArray");
     LOG_SCOPE;
     Type *arrayType = arr->getType();
 
@@ -816,7 +817,7 @@ DSliceValue* DtoCatAssignArray(DValue* arr, Expression* exp)
 
 DSliceValue* DtoCatAssignArray(DValue* arr, Expression* exp)
 {
-    Logger::println("DtoCatAssignArray");
+    IF_LOG Logger::println("DtoCatAssignArray");
     LOG_SCOPE;
 
     DValue* e = exp->toElem(gIR);
@@ -852,7 +853,7 @@ DSliceValue* DtoCatAssignArray(DValue* arr, Expression* exp)
 
 DSliceValue* DtoCatArrays(Type* arrayType, Expression* exp1, Expression* exp2)
 {
-    Logger::println("DtoCatAssignArray");
+    IF_LOG Logger::println("DtoCatAssignArray");
     LOG_SCOPE;
 
     std::vector<LLValue*> args;
@@ -902,7 +903,7 @@ DSliceValue* DtoCatArrays(Type* arrayType, Expression* exp1, Expression* exp2)
 
 DSliceValue* DtoCatArrays(Type* type, Expression* exp1, Expression* exp2)
 {
-    Logger::println("DtoCatArrays");
+    IF_LOG Logger::println("DtoCatArrays");
     LOG_SCOPE;
 
     Type* t1 = exp1->type->toBasetype();
@@ -948,7 +949,7 @@ DSliceValue* DtoCatArrays(Type* type, Expression* exp1, Expression* exp2)
 
 DSliceValue* DtoCatArrayElement(Type* type, Expression* exp1, Expression* exp2)
 {
-    Logger::println("DtoCatArrayElement");
+    IF_LOG Logger::println("DtoCatArrayElement");
     LOG_SCOPE;
 
     Type* t1 = exp1->type->toBasetype();
@@ -1034,7 +1035,7 @@ DSliceValue* DtoAppendDChar(DValue* arr, Expression* exp, const char *func)
 
 DSliceValue* DtoAppendDCharToString(DValue* arr, Expression* exp)
 {
-    Logger::println("DtoAppendDCharToString");
+    IF_LOG Logger::println("DtoAppendDCharToString");
     LOG_SCOPE;
     return DtoAppendDChar(arr, exp, "_d_arrayappendcd");
 }
@@ -1043,7 +1044,7 @@ DSliceValue* DtoAppendDCharToString(DValue* arr, Expression* exp)
 
 DSliceValue* DtoAppendDCharToUnicodeString(DValue* arr, Expression* exp)
 {
-    Logger::println("DtoAppendDCharToUnicodeString");
+    IF_LOG Logger::println("DtoAppendDCharToUnicodeString");
     LOG_SCOPE;
     return DtoAppendDChar(arr, exp, "_d_arrayappendwd");
 }
@@ -1052,7 +1053,7 @@ DSliceValue* DtoAppendDCharToUnicodeString(DValue* arr, Expression* exp)
 // helper for eq and cmp
 static LLValue* DtoArrayEqCmp_impl(Loc& loc, const char* func, DValue* l, DValue* r, bool useti)
 {
-    Logger::println("comparing arrays");
+    IF_LOG Logger::println("comparing arrays");
     LLFunction* fn = LLVM_D_GetRuntimeFunction(gIR->module, func);
     assert(fn);
 
@@ -1060,7 +1061,7 @@ static LLValue* DtoArrayEqCmp_impl(Loc& loc, const char* func, DValue* l, DValue
     Type* commonType = l->getType()->toBasetype()->nextOf()->arrayOf();
 
     // cast static arrays to dynamic ones, this turns them into DSliceValues
-    Logger::println("casting to dynamic arrays");
+    IF_LOG Logger::println("casting to dynamic arrays");
     l = DtoCastArray(loc, l, commonType);
     r = DtoCastArray(loc, r, commonType);
 
@@ -1168,7 +1169,7 @@ LLValue* DtoArrayCompare(Loc& loc, TOK op, DValue* l, DValue* r)
 //////////////////////////////////////////////////////////////////////////////////////////
 LLValue* DtoArrayCastLength(LLValue* len, LLType* elemty, LLType* newelemty)
 {
-    Logger::println("DtoArrayCastLength");
+    IF_LOG Logger::println("DtoArrayCastLength");
     LOG_SCOPE;
 
     assert(len);
@@ -1217,7 +1218,7 @@ LLValue* DtoDynArrayIs(TOK op, DValue* l, DValue* r)
 //////////////////////////////////////////////////////////////////////////////////////////
 LLValue* DtoArrayLen(DValue* v)
 {
-    Logger::println("DtoArrayLen");
+    IF_LOG Logger::println("DtoArrayLen");
     LOG_SCOPE;
 
     Type* t = v->getType()->toBasetype();
@@ -1244,7 +1245,7 @@ LLValue* DtoArrayLen(DValue* v)
 //////////////////////////////////////////////////////////////////////////////////////////
 LLValue* DtoArrayPtr(DValue* v)
 {
-    Logger::println("DtoArrayPtr");
+    IF_LOG Logger::println("DtoArrayPtr");
     LOG_SCOPE;
 
     Type* t = v->getType()->toBasetype();
@@ -1269,7 +1270,7 @@ LLValue* DtoArrayPtr(DValue* v)
 //////////////////////////////////////////////////////////////////////////////////////////
 DValue* DtoCastArray(Loc& loc, DValue* u, Type* to)
 {
-    Logger::println("DtoCastArray");
+    IF_LOG Logger::println("DtoCastArray");
     LOG_SCOPE;
 
     LLType* tolltype = DtoType(to);
@@ -1379,7 +1380,7 @@ DValue* DtoCastArray(Loc& loc, DValue* u, Type* to)
     }
 
     if (isslice) {
-        Logger::println("isslice");
+        IF_LOG Logger::println("isslice");
         return new DSliceValue(to, rval2, rval);
     }
 
@@ -1472,3 +1473,291 @@ void DtoArrayBoundsCheck(Loc& loc, DValue* arr, DValue* index, DValue* lowerBoun
     // if ok, proceed in okbb
     gIR->scope() = IRScope(okbb, oldend);
 }
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+DValue* DtoForeachUtf(Loc& loc, DFuncValue* fnval, Expressions* arguments)
+{
+    // only _aApply[R]cd{1,2} and _aApply[R]wd{1,2} are handled, transcoding
+    // to char or wchar is left to the runtime
+    FuncDeclaration* fdapply = fnval->func;
+    const char* name = fdapply->ident->toChars();
+    size_t namelen = strlen(name);
+    if (fdapply->linkage != LINKc || !arguments || arguments->dim != 2 || strncmp(name, "_aApply", 7) != 0)
+        return NULL;
+    bool reverse = name[7] == 'R';
+    if (namelen != (reverse ? 11 : 10))
+        return NULL;
+    char from = name[namelen-3];
+    if ((from != 'c' && from != 'w') || name[namelen-2] != 'd')
+        return NULL;
+
+    // the loop body, see ForeachStatement::semantic
+    Expression* body = (Expression*)arguments->data[1];
+    if (body->op == TOKcast)
+        body = ((CastExp*)body)->e1;
+    if (body->op != TOKfunction)
+        return NULL;
+    Parameters* params = ((TypeFunction*)body->type->toBasetype()->nextOf())->parameters;
+    size_t nparams = Parameter::dim(params);
+    if (nparams != (size_t)(name[namelen-1] - '0'))
+        return NULL;
+
+    IF_LOG Logger::println("Decoding %s inline", name);
+    LOG_SCOPE;
+
+    Expression* strexp = (Expression*)arguments->data[0];
+    DValue* str = strexp->toElem(gIR);
+    LLValue* len = DtoArrayLen(str);
+    LLValue* ptr = DtoArrayPtr(str);
+    DValue* dg = body->toElem(gIR);
+
+    LLType* sizeTy = DtoSize_t();
+    LLType* i32Ty = LLType::getInt32Ty(gIR->context());
+    LLValue* zero = LLConstantInt::get(sizeTy, 0);
+    LLValue* one = LLConstantInt::get(sizeTy, 1);
+
+    // the arguments of the body
+    Parameter* valparam = Parameter::getNth(params, nparams - 1);
+    LLValue* value = DtoRawAlloca(DtoType(valparam->type), 0, "foreach.dchar");
+    Parameter* keyparam = NULL;
+    LLValue* key = NULL;
+    Expressions* bodyargs = new Expressions;
+    if (nparams == 2)
+    {
+        keyparam = Parameter::getNth(params, 0);
+        key = DtoRawAlloca(DtoType(keyparam->type), 0, "foreach.key");
+        bodyargs->push(DtoLvalueExp(loc, keyparam->type, key));
+    }
+    bodyargs->push(DtoLvalueExp(loc, valparam->type, value));
+
+    // pos is where the next character starts, or ends for foreach_reverse,
+    // index where the current one starts
+    LLValue* pos = DtoRawAlloca(sizeTy, 0, "foreach.pos");
+    LLValue* index = DtoRawAlloca(sizeTy, 0, "foreach.index");
+    LLValue* result = DtoRawAlloca(i32Ty, 0, "foreach.result");
+    DtoStore(reverse ? len : zero, pos);
+    DtoStore(LLConstantInt::get(i32Ty, 0), result);
+
+    llvm::BasicBlock* oldend = gIR->scopeend();
+    llvm::BasicBlock* condbb = llvm::BasicBlock::Create(gIR->context(), "foreach.cond", gIR->topfunc(), oldend);
+    llvm::BasicBlock* decodebb = llvm::BasicBlock::Create(gIR->context(), "foreach.decode", gIR->topfunc(), oldend);
+    llvm::BasicBlock* fastbb = llvm::BasicBlock::Create(gIR->context(), "foreach.fast", gIR->topfunc(), oldend);
+    llvm::BasicBlock* slowbb = llvm::BasicBlock::Create(gIR->context(), "foreach.slow", gIR->topfunc(), oldend);
+    llvm::BasicBlock* bodybb = llvm::BasicBlock::Create(gIR->context(), "foreach.body", gIR->topfunc(), oldend);
+    llvm::BasicBlock* invalidbb = llvm::BasicBlock::Create(gIR->context(), "foreach.invalid", gIR->topfunc(), oldend);
+    llvm::BasicBlock* endbb = llvm::BasicBlock::Create(gIR->context(), "foreach.end", gIR->topfunc(), oldend);
+
+    gIR->ir->CreateBr(condbb);
+
+    // cond: any characters left?
+    gIR->scope() = IRScope(condbb, decodebb);
+    LLValue* cur = DtoLoad(pos);
+    if (reverse)
+        gIR->ir->CreateCondBr(gIR->ir->CreateICmpNE(cur, zero), decodebb, endbb);
+    else
+        gIR->ir->CreateCondBr(gIR->ir->CreateICmpULT(cur, len), decodebb, endbb);
+
+    // decode: ASCII characters (or the BMP below the surrogates for UTF-16)
+    // are taken as they are
+    gIR->scope() = IRScope(decodebb, fastbb);
+    LLValue* i = reverse ? gIR->ir->CreateSub(cur, one) : cur;
+    LLValue* unit = DtoLoad(DtoGEP1(ptr, i));
+    LLValue* unit32 = gIR->ir->CreateZExt(unit, i32Ty);
+    LLValue* isfast = gIR->ir->CreateICmpULT(unit32, LLConstantInt::get(i32Ty, from == 'c' ? 0x80 : 0xD800));
+    gIR->ir->CreateCondBr(isfast, fastbb, slowbb);
+
+    gIR->scope() = IRScope(fastbb, slowbb);
+    DtoStore(unit32, value);
+    DtoStore(i, index);
+    DtoStore(reverse ? i : gIR->ir->CreateAdd(i, one), pos);
+    gIR->ir->CreateBr(bodybb);
+
+    gIR->scope() = IRScope(slowbb, bodybb);
+    if (from == 'c' && !reverse)
+    {
+        // strict UTF-8 decoding, like the runtime does
+        llvm::BasicBlock* trailbb = llvm::BasicBlock::Create(gIR->context(), "foreach.trail", gIR->topfunc(), bodybb);
+        llvm::BasicBlock* nexttrailbb = llvm::BasicBlock::Create(gIR->context(), "foreach.nexttrail", gIR->topfunc(), bodybb);
+        llvm::BasicBlock* checkbb = llvm::BasicBlock::Create(gIR->context(), "foreach.check", gIR->topfunc(), bodybb);
+
+        LLValue* four = LLConstantInt::get(sizeTy, 4);
+        LLValue* three = LLConstantInt::get(sizeTy, 3);
+        LLValue* two = LLConstantInt::get(sizeTy, 2);
+        LLValue* n = gIR->ir->CreateSelect(gIR->ir->CreateICmpUGE(unit32, LLConstantInt::get(i32Ty, 0xF0)), four,
+            gIR->ir->CreateSelect(gIR->ir->CreateICmpUGE(unit32, LLConstantInt::get(i32Ty, 0xE0)), three, two));
+        LLValue* ok = gIR->ir->CreateAnd(
+            gIR->ir->CreateICmpUGE(unit32, LLConstantInt::get(i32Ty, 0xC2)),
+            gIR->ir->CreateICmpULE(unit32, LLConstantInt::get(i32Ty, 0xF4)));
+        ok = gIR->ir->CreateAnd(ok, gIR->ir->CreateICmpULE(n, gIR->ir->CreateSub(len, i)));
+        LLValue* mask = gIR->ir->CreateLShr(LLConstantInt::get(i32Ty, 0x7F), gIR->ir->CreateTrunc(n, i32Ty));
+        DtoStore(gIR->ir->CreateAnd(unit32, mask), value);
+        LLValue* k = DtoRawAlloca(sizeTy, 0, "foreach.k");
+        DtoStore(one, k);
+        gIR->ir->CreateCondBr(ok, trailbb, invalidbb);
+
+        // the trailing bytes are 10xxxxxx
+        gIR->scope() = IRScope(trailbb, nexttrailbb);
+        LLValue* kval = DtoLoad(k);
+        LLValue* trail = gIR->ir->CreateZExt(DtoLoad(DtoGEP1(ptr, gIR->ir->CreateAdd(i, kval))), i32Ty);
+        LLValue* c = gIR->ir->CreateShl(DtoLoad(value), LLConstantInt::get(i32Ty, 6));
+        DtoStore(gIR->ir->CreateOr(c, gIR->ir->CreateAnd(trail, LLConstantInt::get(i32Ty, 0x3F))), value);
+        kval = gIR->ir->CreateAdd(kval, one);
+        DtoStore(kval, k);
+        ok = gIR->ir->CreateICmpEQ(gIR->ir->CreateAnd(trail, LLConstantInt::get(i32Ty, 0xC0)), LLConstantInt::get(i32Ty, 0x80));
+        gIR->ir->CreateCondBr(ok, nexttrailbb, invalidbb);
+
+        gIR->scope() = IRScope(nexttrailbb, checkbb);
+        gIR->ir->CreateCondBr(gIR->ir->CreateICmpULT(kval, n), trailbb, checkbb);
+
+        // no overlong encodings, surrogates or values past 0x10FFFF
+        gIR->scope() = IRScope(checkbb, bodybb);
+        c = DtoLoad(value);
+        LLValue* min = gIR->ir->CreateSelect(gIR->ir->CreateICmpEQ(n, two), LLConstantInt::get(i32Ty, 0x80),
+            gIR->ir->CreateSelect(gIR->ir->CreateICmpEQ(n, three), LLConstantInt::get(i32Ty, 0x800), LLConstantInt::get(i32Ty, 0x10000)));
+        ok = gIR->ir->CreateAnd(gIR->ir->CreateICmpUGE(c, min), gIR->ir->CreateICmpULE(c, LLConstantInt::get(i32Ty, 0x10FFFF)));
+        ok = gIR->ir->CreateAnd(ok, gIR->ir->CreateICmpUGE(
+            gIR->ir->CreateSub(c, LLConstantInt::get(i32Ty, 0xD800)), LLConstantInt::get(i32Ty, 0x800)));
+        ok = gIR->ir->CreateAnd(ok, gIR->ir->CreateICmpNE(
+            gIR->ir->CreateOr(c, LLConstantInt::get(i32Ty, 1)), LLConstantInt::get(i32Ty, 0xFFFF)));
+        DtoStore(i, index);
+        DtoStore(gIR->ir->CreateAdd(i, n), pos);
+        gIR->ir->CreateCondBr(ok, bodybb, invalidbb);
+    }
+    else if (from == 'c')
+    {
+        // walk back to the first byte, exactly like _aApplyRcd does
+        llvm::BasicBlock* scanbb = llvm::BasicBlock::Create(gIR->context(), "foreach.scan", gIR->topfunc(), bodybb);
+        llvm::BasicBlock* stepbb = llvm::BasicBlock::Create(gIR->context(), "foreach.step", gIR->topfunc(), bodybb);
+        llvm::BasicBlock* leadbb = llvm::BasicBlock::Create(gIR->context(), "foreach.lead", gIR->topfunc(), bodybb);
+
+        LLValue* byte = DtoRawAlloca(unit->getType(), 0, "foreach.byte");
+        LLValue* shift = DtoRawAlloca(i32Ty, 0, "foreach.shift");
+        LLValue* mask = DtoRawAlloca(i32Ty, 0, "foreach.mask");
+        DtoStore(unit, byte);
+        DtoStore(LLConstantInt::get(i32Ty, 0), value);
+        DtoStore(LLConstantInt::get(i32Ty, 0), shift);
+        DtoStore(LLConstantInt::get(i32Ty, 0x3F), mask);
+        DtoStore(i, index);
+        gIR->ir->CreateBr(scanbb);
+
+        gIR->scope() = IRScope(scanbb, stepbb);
+        LLValue* b = gIR->ir->CreateZExt(DtoLoad(byte), i32Ty);
+        LLValue* islead = gIR->ir->CreateICmpEQ(gIR->ir->CreateAnd(b, LLConstantInt::get(i32Ty, 0xC0)), LLConstantInt::get(i32Ty, 0xC0));
+        LLValue* j = DtoLoad(index);
+        llvm::BasicBlock* notleadbb = llvm::BasicBlock::Create(gIR->context(), "foreach.notlead", gIR->topfunc(), stepbb);
+        gIR->ir->CreateCondBr(islead, leadbb, notleadbb);
+
+        gIR->scope() = IRScope(notleadbb, stepbb);
+        gIR->ir->CreateCondBr(gIR->ir->CreateICmpEQ(j, zero), invalidbb, stepbb);
+
+        gIR->scope() = IRScope(stepbb, leadbb);
+        j = gIR->ir->CreateSub(j, one);
+        DtoStore(j, index);
+        LLValue* sh = DtoLoad(shift);
+        LLValue* bits = gIR->ir->CreateShl(gIR->ir->CreateAnd(b, LLConstantInt::get(i32Ty, 0x3F)), sh);
+        DtoStore(gIR->ir->CreateOr(DtoLoad(value), bits), value);
+        DtoStore(gIR->ir->CreateAdd(sh, LLConstantInt::get(i32Ty, 6)), shift);
+        DtoStore(gIR->ir->CreateLShr(DtoLoad(mask), LLConstantInt::get(i32Ty, 1)), mask);
+        DtoStore(DtoLoad(DtoGEP1(ptr, j)), byte);
+        gIR->ir->CreateBr(scanbb);
+
+        gIR->scope() = IRScope(leadbb, bodybb);
+        bits = gIR->ir->CreateShl(gIR->ir->CreateAnd(b, DtoLoad(mask)), DtoLoad(shift));
+        DtoStore(gIR->ir->CreateOr(DtoLoad(value), bits), value);
+        DtoStore(DtoLoad(index), pos);
+        gIR->ir->CreateBr(bodybb);
+    }
+    else if (!reverse)
+    {
+        // the rest of the BMP, or a surrogate pair
+        llvm::BasicBlock* bmpbb = llvm::BasicBlock::Create(gIR->context(), "foreach.bmp", gIR->topfunc(), bodybb);
+        llvm::BasicBlock* pairbb = llvm::BasicBlock::Create(gIR->context(), "foreach.pair", gIR->topfunc(), bodybb);
+        llvm::BasicBlock* lowbb = llvm::BasicBlock::Create(gIR->context(), "foreach.low", gIR->topfunc(), bodybb);
+
+        DtoStore(i, index);
+        LLValue* isbmp = gIR->ir->CreateAnd(
+            gIR->ir->CreateICmpUGE(unit32, LLConstantInt::get(i32Ty, 0xE000)),
+            gIR->ir->CreateICmpULE(unit32, LLConstantInt::get(i32Ty, 0xFFFD)));
+        gIR->ir->CreateCondBr(isbmp, bmpbb, pairbb);
+
+        gIR->scope() = IRScope(bmpbb, pairbb);
+        DtoStore(unit32, value);
+        DtoStore(gIR->ir->CreateAdd(i, one), pos);
+        gIR->ir->CreateBr(bodybb);
+
+        gIR->scope() = IRScope(pairbb, lowbb);
+        LLValue* ok = gIR->ir->CreateAnd(
+            gIR->ir->CreateICmpULE(unit32, LLConstantInt::get(i32Ty, 0xDBFF)),
+            gIR->ir->CreateICmpUGT(gIR->ir->CreateSub(len, i), one));
+        gIR->ir->CreateCondBr(ok, lowbb, invalidbb);
+
+        gIR->scope() = IRScope(lowbb, bodybb);
+        LLValue* low = gIR->ir->CreateZExt(DtoLoad(DtoGEP1(ptr, gIR->ir->CreateAdd(i, one))), i32Ty);
+        low = gIR->ir->CreateSub(low, LLConstantInt::get(i32Ty, 0xDC00));
+        LLValue* c = gIR->ir->CreateShl(gIR->ir->CreateSub(unit32, LLConstantInt::get(i32Ty, 0xD800)), LLConstantInt::get(i32Ty, 10));
+        c = gIR->ir->CreateAdd(gIR->ir->CreateAdd(c, low), LLConstantInt::get(i32Ty, 0x10000));
+        DtoStore(c, value);
+        DtoStore(gIR->ir->CreateAdd(i, LLConstantInt::get(sizeTy, 2)), pos);
+        gIR->ir->CreateCondBr(gIR->ir->CreateICmpULT(low, LLConstantInt::get(i32Ty, 0x400)), bodybb, invalidbb);
+    }
+    else
+    {
+        // a low surrogate is combined with the unit before it, exactly like
+        // _aApplyRwd does
+        llvm::BasicBlock* pairbb = llvm::BasicBlock::Create(gIR->context(), "foreach.pair", gIR->topfunc(), bodybb);
+        llvm::BasicBlock* singlebb = llvm::BasicBlock::Create(gIR->context(), "foreach.single", gIR->topfunc(), bodybb);
+        llvm::BasicBlock* highbb = llvm::BasicBlock::Create(gIR->context(), "foreach.high", gIR->topfunc(), bodybb);
+
+        LLValue* islow = gIR->ir->CreateICmpULT(
+            gIR->ir->CreateSub(unit32, LLConstantInt::get(i32Ty, 0xDC00)), LLConstantInt::get(i32Ty, 0x400));
+        gIR->ir->CreateCondBr(islow, pairbb, singlebb);
+
+        gIR->scope() = IRScope(singlebb, pairbb);
+        DtoStore(unit32, value);
+        DtoStore(i, index);
+        DtoStore(i, pos);
+        gIR->ir->CreateBr(bodybb);
+
+        gIR->scope() = IRScope(pairbb, highbb);
+        gIR->ir->CreateCondBr(gIR->ir->CreateICmpEQ(i, zero), invalidbb, highbb);
+
+        gIR->scope() = IRScope(highbb, bodybb);
+        LLValue* j = gIR->ir->CreateSub(i, one);
+        LLValue* high = gIR->ir->CreateZExt(DtoLoad(DtoGEP1(ptr, j)), i32Ty);
+        LLValue* c = gIR->ir->CreateShl(gIR->ir->CreateSub(high, LLConstantInt::get(i32Ty, 0xD7C0)), LLConstantInt::get(i32Ty, 10));
+        DtoStore(gIR->ir->CreateAdd(c, gIR->ir->CreateSub(unit32, LLConstantInt::get(i32Ty, 0xDC00))), value);
+        DtoStore(j, index);
+        DtoStore(j, pos);
+        gIR->ir->CreateBr(bodybb);
+    }
+
+    // body: call the loop body, a non-zero result ends the loop
+    gIR->scope() = IRScope(bodybb, invalidbb);
+    if (key)
+    {
+        DImValue idx(Type::tsize_t, DtoLoad(index));
+        DtoStore(DtoCast(loc, &idx, keyparam->type)->getRVal(), key);
+    }
+    LLValue* ret = DtoCallFunction(loc, Type::tint32, dg, bodyargs)->getRVal();
+    DtoStore(ret, result);
+    gIR->ir->CreateCondBr(gIR->ir->CreateICmpEQ(ret, LLConstantInt::get(i32Ty, 0)), condbb, endbb);
+
+    // invalid: let the runtime function report the error, by handing it the
+    // rest of the string
+    gIR->scope() = IRScope(invalidbb, endbb);
+    LLValue* slice = DtoAlloca(strexp->type, ".slice");
+    DVarValue rest(strexp->type, slice);
+    if (reverse)
+        DtoSetArray(&rest, cur, ptr);
+    else
+        DtoSetArray(&rest, gIR->ir->CreateSub(len, i), DtoGEP1(ptr, i));
+    Expressions* rtargs = new Expressions;
+    rtargs->push(DtoLvalueExp(loc, strexp->type, slice));
+    rtargs->push(arguments->data[1]);
+    DtoStore(DtoCallFunction(loc, Type::tint32, fnval, rtargs)->getRVal(), result);
+    gIR->ir->CreateBr(endbb);
+
+    gIR->scope() = IRScope(endbb, oldend);
+    return new DImValue(Type::tint32, DtoLoad(result));
+}
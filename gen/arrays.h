@@ -4,6 +4,7 @@
 struct ArrayInitializer;
 
 struct DSliceValue;
+struct DFuncValue;
 
 llvm::StructType* DtoArrayType(Type* arrayTy);
 llvm::StructType* DtoArrayType(LLType* elemTy);
@@ -56,4 +57,9 @@ DValue* DtoCastArray(Loc& loc, DValue* val, Type* to);
 // generates an array bounds check
 void DtoArrayBoundsCheck(Loc& loc, DValue* arr, DValue* index, DValue* lowerBound = 0);
 
+// Emits a call to one of the runtime functions foreach uses to decode narrow
+// strings to dchar as an inline loop calling the body directly. Returns NULL
+// if fnval is not such a function.
+DValue* DtoForeachUtf(Loc& loc, DFuncValue* fnval, Expressions* arguments);
+
 #endif // LLVMC_GEN_ARRAYS_H
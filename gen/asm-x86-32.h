@@ -1475,7 +1475,7 @@ namespace AsmParserx8632
         {
             AsmCode * asmcode = new AsmCode ( N_Regs );
             asmcode->insnTemplate = insnTemplate.str();
-            Logger::cout() << "insnTemplate = " << asmcode->insnTemplate << '\n';
+            IF_LOG Logger::cout() << "insnTemplate = " << asmcode->insnTemplate << '\n';
             stmt->asmcode = ( code* ) asmcode;
         }
 
@@ -2256,7 +2256,7 @@ namespace AsmParserx8632
             }
 
             asmcode->insnTemplate = insnTemplate.str();
-            Logger::cout() << "insnTemplate = " << asmcode->insnTemplate << '\n';
+            IF_LOG Logger::cout() << "insnTemplate = " << asmcode->insnTemplate << '\n';
             return true;
         }
 
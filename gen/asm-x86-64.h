@@ -1588,7 +1588,7 @@ namespace AsmParserx8664
         {
             AsmCode * asmcode = new AsmCode ( N_Regs );
             asmcode->insnTemplate = insnTemplate.str();
-            Logger::cout() << "insnTemplate = " << asmcode->insnTemplate << '\n';
+            IF_LOG Logger::cout() << "insnTemplate = " << asmcode->insnTemplate << '\n';
             stmt->asmcode = ( code* ) asmcode;
         }
 
@@ -2392,7 +2392,7 @@ namespace AsmParserx8664
             }
 
             asmcode->insnTemplate = insnTemplate.str();
-            Logger::cout() << "insnTemplate = " << asmcode->insnTemplate << '\n';
+            IF_LOG Logger::cout() << "insnTemplate = " << asmcode->insnTemplate << '\n';
             return true;
         }
 
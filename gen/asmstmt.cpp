@@ -196,7 +196,7 @@ int AsmStatement::blockExit(bool mustNotThrow)
 void
 AsmStatement::toIR(IRState * irs)
 {
-    Logger::println("AsmStatement::toIR(): %s", loc.toChars());
+    IF_LOG Logger::println("AsmStatement::toIR(): %s", loc.toChars());
     LOG_SCOPE;
 
     // sanity check
@@ -511,9 +511,9 @@ LLValue* DtoAggrPairSwap(LLValue* aggr);
 
 void AsmBlockStatement::toIR(IRState* p)
 {
-    Logger::println("AsmBlockStatement::toIR(): %s", loc.toChars());
+    IF_LOG Logger::println("AsmBlockStatement::toIR(): %s", loc.toChars());
     LOG_SCOPE;
-    Logger::println("BEGIN ASM");
+    IF_LOG Logger::println("BEGIN ASM");
 
     // disable inlining by default
     if (!p->func()->decl->allowInlining)
@@ -591,7 +591,7 @@ void AsmBlockStatement::toIR(IRState* p)
             gotoToVal[a->isBranchToLabel] = n_goto;
 
             // provide an in-asm target for the branch and set value
-            Logger::println("statement '%s' references outer label '%s': creating forwarder", a->code.c_str(), a->isBranchToLabel->string);
+            IF_LOG Logger::println("statement '%s' references outer label '%s': creating forwarder", a->code.c_str(), a->isBranchToLabel->string);
             printLabelName(code, fdmangle, a->isBranchToLabel->string);
             code << ":\n\t";
             code << "movl $<<in" << n_goto << ">>, $<<out0>>\n";
@@ -647,7 +647,7 @@ void AsmBlockStatement::toIR(IRState* p)
     std::string code;
     size_t asmIdx = asmblock->retn;
 
-    Logger::println("do outputs");
+    IF_LOG Logger::println("do outputs");
     size_t n = asmblock->s.size();
     for (size_t i=0; i<n; ++i)
     {
@@ -667,7 +667,7 @@ void AsmBlockStatement::toIR(IRState* p)
         asmIdx += onn;
     }
 
-    Logger::println("do inputs");
+    IF_LOG Logger::println("do inputs");
     for (size_t i=0; i<n; ++i)
     {
         IRAsmStmt* a = asmblock->s[i];
@@ -704,8 +704,8 @@ void AsmBlockStatement::toIR(IRState* p)
     if (!out_c.empty())
         out_c.resize(out_c.size()-1);
 
-    Logger::println("code = \"%s\"", code.c_str());
-    Logger::println("constraints = \"%s\"", out_c.c_str());
+    IF_LOG Logger::println("code = \"%s\"", code.c_str());
+    IF_LOG Logger::println("constraints = \"%s\"", out_c.c_str());
 
     // build return types
     LLType* retty;
@@ -759,7 +759,7 @@ void AsmBlockStatement::toIR(IRState* p)
     }
 
     p->asmBlock = NULL;
-    Logger::println("END ASM");
+    IF_LOG Logger::println("END ASM");
 
     // if asm contained external branches, emit goto forwarder code
     if(!gotoToVal.empty())
@@ -822,7 +822,7 @@ Statement *AsmBlockStatement::semantic(Scope *sc)
 
 void AsmStatement::toNakedIR(IRState *p)
 {
-    Logger::println("AsmStatement::toNakedIR(): %s", loc.toChars());
+    IF_LOG Logger::println("AsmStatement::toNakedIR(): %s", loc.toChars());
     LOG_SCOPE;
 
     // is there code?
@@ -836,7 +836,7 @@ void AsmStatement::toNakedIR(IRState *p)
 
 void AsmBlockStatement::toNakedIR(IRState *p)
 {
-    Logger::println("AsmBlockStatement::toNakedIR(): %s", loc.toChars());
+    IF_LOG Logger::println("AsmBlockStatement::toNakedIR(): %s", loc.toChars());
     LOG_SCOPE;
 
     // do asm statements
@@ -107,17 +107,17 @@ LLValue* DtoBinNumericEquals(Loc loc, DValue* lhs, DValue* rhs, TOK op)
            op == TOKidentity || op == TOKnotidentity);
     Type* t = lhs->getType()->toBasetype();
     assert(t->isfloating());
-    Logger::println("numeric equality");
+    IF_LOG Logger::println("numeric equality");
 
     LLValue* res = 0;
     if (t->iscomplex())
     {
-        Logger::println("complex");
+        IF_LOG Logger::println("complex");
         res = DtoComplexEquals(loc, op, lhs, rhs);
     }
     else if (t->isfloating())
     {
-        Logger::println("floating");
+        IF_LOG Logger::println("floating");
         res = DtoBinFloatsEquals(loc, lhs, rhs, op);
     }
     
@@ -23,6 +23,12 @@
 #include "ir/irstruct.h"
 #include "ir/irtypeclass.h"
 
+#include "attrib.h"
+#include "module.h"
+#include "template.h"
+
+#include <set>
+
 //////////////////////////////////////////////////////////////////////////////////////////
 
 // FIXME: this needs to be cleaned up
@@ -44,7 +50,7 @@ void DtoResolveClass(ClassDeclaration* cd)
     if (cd->ir.resolved) return;
     cd->ir.resolved = true;
 
-    Logger::println("DtoResolveClass(%s): %s", cd->toPrettyChars(), cd->loc.toChars());
+    IF_LOG Logger::println("DtoResolveClass(%s): %s", cd->toPrettyChars(), cd->loc.toChars());
     LOG_SCOPE;
 
     // make sure type exists
@@ -157,7 +163,7 @@ DValue* DtoNewClass(Loc loc, TypeClass* tc, NewExp* newexp)
     // init inner-class outer reference
     if (newexp->thisexp)
     {
-        Logger::println("Resolving outer class");
+        IF_LOG Logger::println("Resolving outer class");
         LOG_SCOPE;
         DValue* thisval = newexp->thisexp->toElem(gIR);
         size_t idx = tc->sym->vthis->ir.irField->index;
@@ -176,7 +182,7 @@ DValue* DtoNewClass(Loc loc, TypeClass* tc, NewExp* newexp)
     // call constructor
     if (newexp->member)
     {
-        Logger::println("Calling constructor");
+        IF_LOG Logger::println("Calling constructor");
         assert(newexp->arguments != NULL);
         newexp->member->codegen(Type::sir);
         DFuncValue dfn(newexp->member, newexp->member->ir.irFunc->func, mem);
@@ -237,7 +243,7 @@ void DtoFinalizeClass(LLValue* inst)
 
 DValue* DtoCastClass(DValue* val, Type* _to)
 {
-    Logger::println("DtoCastClass(%s, %s)", val->getType()->toChars(), _to->toChars());
+    IF_LOG Logger::println("DtoCastClass(%s, %s)", val->getType()->toChars(), _to->toChars());
     LOG_SCOPE;
 
     Type* to = _to->toBasetype();
@@ -280,15 +286,15 @@ DValue* DtoCastClass(DValue* val, Type* _to)
 
     // x -> interface
     if (InterfaceDeclaration* it = tc->sym->isInterfaceDeclaration()) {
-        Logger::println("to interface");
+        IF_LOG Logger::println("to interface");
         // interface -> interface
         if (fc->sym->isInterfaceDeclaration()) {
-            Logger::println("from interface");
+            IF_LOG Logger::println("from interface");
             return DtoDynamicCastInterface(val, _to);
         }
         // class -> interface - static cast
         else if (it->isBaseOf(fc->sym,NULL)) {
-            Logger::println("static down cast");
+            IF_LOG Logger::println("static down cast");
 
             // get the from class
             ClassDeclaration* cd = fc->sym->isClassDeclaration();
@@ -307,8 +313,8 @@ DValue* DtoCastClass(DValue* val, Type* _to)
             LLType* ifType = DtoType(_to);
             if (Logger::enabled())
             {
-                Logger::cout() << "V = " << *v << std::endl;
-                Logger::cout() << "T = " << *ifType << std::endl;
+                IF_LOG Logger::cout() << "V = " << *v << std::endl;
+                IF_LOG Logger::cout() << "T = " << *ifType << std::endl;
             }
             v = DtoBitCast(v, ifType);
 
@@ -324,28 +330,28 @@ DValue* DtoCastClass(DValue* val, Type* _to)
         }
         // class -> interface
         else {
-            Logger::println("from object");
+            IF_LOG Logger::println("from object");
             return DtoDynamicCastObject(val, _to);
         }
     }
     // x -> class
     else {
-        Logger::println("to class");
+        IF_LOG Logger::println("to class");
         // interface -> class
         if (fc->sym->isInterfaceDeclaration()) {
-            Logger::println("interface cast");
+            IF_LOG Logger::println("interface cast");
             return DtoDynamicCastInterface(val, _to);
         }
         // class -> class - static down cast
         else if (tc->sym->isBaseOf(fc->sym,NULL)) {
-            Logger::println("static down cast");
+            IF_LOG Logger::println("static down cast");
             LLType* tolltype = DtoType(_to);
             LLValue* rval = DtoBitCast(val->getRVal(), tolltype);
             return new DImValue(_to, rval);
         }
         // class -> class - dynamic up cast
         else {
-            Logger::println("dynamic up cast");
+            IF_LOG Logger::println("dynamic up cast");
             return DtoDynamicCastObject(val, _to);
         }
     }
@@ -353,6 +359,79 @@ DValue* DtoCastClass(DValue* val, Type* _to)
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
+// Emits a dynamic cast of obj to the class 'to', which must not be an
+// interface. Objects of exactly class 'to' (and for final classes, only
+// those) are handled inline. Otherwise a per call site cache holding the
+// ClassInfo of the last object that was successfully cast through the
+// runtime is checked, before calling the runtime for real.
+static LLValue* DtoDynamicCastToClass(LLValue* obj, TypeClass* to, llvm::Function* func, LLValue* cinfo)
+{
+    LLFunctionType* funcTy = func->getFunctionType();
+    LLValue* nullobj = LLConstant::getNullValue(obj->getType());
+
+    llvm::BasicBlock* oldend = gIR->scopeend();
+    llvm::BasicBlock* entrybb = gIR->scopebb();
+    llvm::BasicBlock* checkbb = llvm::BasicBlock::Create(gIR->context(), "dyncast.check", gIR->topfunc(), oldend);
+    llvm::BasicBlock* endbb = llvm::BasicBlock::Create(gIR->context(), "dyncast.end", gIR->topfunc(), oldend);
+
+    // null casts to null
+    LLValue* isNull = gIR->ir->CreateICmpEQ(obj, nullobj, ".nullcheck");
+    gIR->ir->CreateCondBr(isNull, endbb, checkbb);
+
+    // compare the ClassInfo from vtbl[0] with the target
+    gIR->scope() = IRScope(checkbb, endbb);
+    LLValue* vtbl = DtoLoad(DtoGEPi(obj, 0, 0), ".vtbl");
+    LLValue* objci = DtoBitCast(DtoLoad(DtoGEPi(vtbl, 0, 0)), getVoidPtrType(), ".classinfo");
+    LLValue* toci = DtoBitCast(cinfo, getVoidPtrType());
+    LLValue* exact = gIR->ir->CreateICmpEQ(objci, toci, ".exact");
+
+    llvm::PHINode* phi;
+    if (to->sym->storage_class & STCfinal)
+    {
+        // no subclasses, so this is the only way to succeed
+        LLValue* res = gIR->ir->CreateSelect(exact, obj, nullobj, ".dyncast");
+        gIR->ir->CreateBr(endbb);
+
+        gIR->scope() = IRScope(endbb, oldend);
+        phi = gIR->ir->CreatePHI(obj->getType(), 2, ".dyncast");
+        phi->addIncoming(nullobj, entrybb);
+        phi->addIncoming(res, checkbb);
+        return phi;
+    }
+
+    llvm::BasicBlock* cachebb = llvm::BasicBlock::Create(gIR->context(), "dyncast.cache", gIR->topfunc(), endbb);
+    llvm::BasicBlock* slowbb = llvm::BasicBlock::Create(gIR->context(), "dyncast.slow", gIR->topfunc(), endbb);
+    gIR->ir->CreateCondBr(exact, endbb, cachebb);
+
+    // racing updates are harmless, any ClassInfo stored is a valid hit
+    gIR->scope() = IRScope(cachebb, slowbb);
+    llvm::GlobalVariable* cache = new llvm::GlobalVariable(*gIR->module, getVoidPtrType(), false,
+        llvm::GlobalValue::InternalLinkage, LLConstant::getNullValue(getVoidPtrType()), ".dyncast.cache");
+    LLValue* hit = gIR->ir->CreateICmpEQ(objci, DtoLoad(cache), ".cachehit");
+    gIR->ir->CreateCondBr(hit, endbb, slowbb);
+
+    // ask the runtime and remember the ClassInfo on success
+    gIR->scope() = IRScope(slowbb, endbb);
+    LLValue* ret = gIR->CreateCallOrInvoke2(func, DtoBitCast(obj, funcTy->getParamType(0)),
+        DtoBitCast(cinfo, funcTy->getParamType(1)), "tmp").getInstruction();
+    ret = DtoBitCast(ret, obj->getType());
+    llvm::BasicBlock* storebb = llvm::BasicBlock::Create(gIR->context(), "dyncast.store", gIR->topfunc(), endbb);
+    llvm::BasicBlock* slowendbb = gIR->scopebb();
+    gIR->ir->CreateCondBr(gIR->ir->CreateICmpEQ(ret, nullobj), endbb, storebb);
+    gIR->scope() = IRScope(storebb, endbb);
+    DtoStore(objci, cache);
+    gIR->ir->CreateBr(endbb);
+
+    gIR->scope() = IRScope(endbb, oldend);
+    phi = gIR->ir->CreatePHI(obj->getType(), 5, ".dyncast");
+    phi->addIncoming(nullobj, entrybb);
+    phi->addIncoming(obj, checkbb);
+    phi->addIncoming(obj, cachebb);
+    phi->addIncoming(nullobj, slowendbb);
+    phi->addIncoming(obj, storebb);
+    return phi;
+}
+
 DValue* DtoDynamicCastObject(DValue* val, Type* _to)
 {
     // call:
@@ -376,6 +455,14 @@ DValue* DtoDynamicCastObject(DValue* val, Type* _to)
     to->sym->codegen(Type::sir);
 
     LLValue* cinfo = to->sym->ir.irStruct->getClassInfoSymbol();
+
+    // class targets are checked inline first
+    if (!to->sym->isInterfaceDeclaration())
+    {
+        LLValue* ret = DtoDynamicCastToClass(obj, to, func, cinfo);
+        return new DImValue(_to, DtoBitCast(ret, DtoType(_to)));
+    }
+
     // unfortunately this is needed as the implementation of object differs somehow from the declaration
     // this could happen in user code as well :/
     cinfo = DtoBitCast(cinfo, funcTy->getParamType(1));
@@ -439,6 +526,46 @@ DValue* DtoDynamicCastInterface(DValue* val, Type* _to)
     TypeClass* to = (TypeClass*)_to->toBasetype();
     to->sym->codegen(Type::sir);
     LLValue* cinfo = to->sym->ir.irStruct->getClassInfoSymbol();
+
+    // for class targets, get the object inline like _d_toObject and
+    // check it inline first
+    TypeClass* from = (TypeClass*)val->getType()->toBasetype();
+    if (!to->sym->isInterfaceDeclaration() &&
+        !from->sym->isCOMinterface() && !from->sym->isCPPinterface())
+    {
+        LLType* objtype = DtoType(ClassDeclaration::object->type);
+        LLValue* nullobj = LLConstant::getNullValue(objtype);
+
+        llvm::BasicBlock* oldend = gIR->scopeend();
+        llvm::BasicBlock* entrybb = gIR->scopebb();
+        llvm::BasicBlock* tobjbb = llvm::BasicBlock::Create(gIR->context(), "dyncast.toobject", gIR->topfunc(), oldend);
+        llvm::BasicBlock* endbb = llvm::BasicBlock::Create(gIR->context(), "dyncast.ifaceend", gIR->topfunc(), oldend);
+
+        LLValue* isNull = gIR->ir->CreateICmpEQ(ptr, LLConstant::getNullValue(ptr->getType()), ".nullcheck");
+        gIR->ir->CreateCondBr(isNull, endbb, tobjbb);
+
+        // the Interface* in vtbl[0] has the offset of the interface in the
+        // object as its last member, after the ClassInfo and the vtbl slice
+        gIR->scope() = IRScope(tobjbb, endbb);
+        LLValue* p = DtoBitCast(ptr, getPtrToType(getPtrToType(getVoidPtrType())));
+        LLValue* pi = DtoLoad(DtoLoad(p), ".interface");
+        LLValue* offset = DtoGEPi1(pi, 3 * getTypePaddedSize(DtoSize_t()));
+        offset = DtoLoad(DtoBitCast(offset, getPtrToType(DtoSize_t())), ".offset");
+        LLValue* obj = gIR->ir->CreateGEP(ptr, gIR->ir->CreateNeg(offset));
+        obj = DtoBitCast(obj, objtype);
+
+        llvm::Function* objfunc = LLVM_D_GetRuntimeFunction(gIR->module, "_d_dynamic_cast");
+        LLValue* ret = DtoDynamicCastToClass(obj, to, objfunc, cinfo);
+        llvm::BasicBlock* tobjendbb = gIR->scopebb();
+        gIR->ir->CreateBr(endbb);
+
+        gIR->scope() = IRScope(endbb, oldend);
+        llvm::PHINode* phi = gIR->ir->CreatePHI(objtype, 2, ".dyncast");
+        phi->addIncoming(nullobj, entrybb);
+        phi->addIncoming(ret, tobjendbb);
+        return new DImValue(_to, DtoBitCast(phi, DtoType(_to)));
+    }
+
     // unfortunately this is needed as the implementation of object differs somehow from the declaration
     // this could happen in user code as well :/
     cinfo = DtoBitCast(cinfo, funcTy->getParamType(1));
@@ -456,7 +583,7 @@ DValue* DtoDynamicCastInterface(DValue* val, Type* _to)
 
 LLValue* DtoIndexClass(LLValue* src, ClassDeclaration* cd, VarDeclaration* vd)
 {
-    Logger::println("indexing class field %s:", vd->toPrettyChars());
+    IF_LOG Logger::println("indexing class field %s:", vd->toPrettyChars());
     LOG_SCOPE;
 
     if (Logger::enabled())
@@ -478,9 +605,9 @@ LLValue* DtoIndexClass(LLValue* src, ClassDeclaration* cd, VarDeclaration* vd)
 #if 0
     if (Logger::enabled())
     {
-        Logger::cout() << "src2: " << *src << '\n';
-        Logger::cout() << "index: " << field->index << '\n';
-        Logger::cout() << "srctype: " << *src->getType() << '\n';
+        IF_LOG Logger::cout() << "src2: " << *src << '\n';
+        IF_LOG Logger::cout() << "index: " << field->index << '\n';
+        IF_LOG Logger::cout() << "srctype: " << *src->getType() << '\n';
     }
 #endif
     LLValue* val = DtoGEPi(src, 0, field->index);
@@ -547,6 +674,74 @@ LLValue* DtoVirtualFunctionPointer(DValue* inst, FuncDeclaration* fdecl, char* n
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
+FuncDeclaration* DtoVirtualFunctionTarget(ClassDeclaration* cd, FuncDeclaration* fdecl)
+{
+    if (cd->isInterfaceDeclaration() || fdecl->vtblIndex <= 0 ||
+        (unsigned)fdecl->vtblIndex >= cd->vtbl.dim)
+        return NULL;
+
+    FuncDeclaration* fd = cd->vtbl.tdata()[fdecl->vtblIndex]->isFuncDeclaration();
+    if (!fd || fd->isAbstract())
+        return NULL;
+    return fd;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// all functions overridden by some class of the program as far as we know it
+static std::set<FuncDeclaration*> overriddenFuncs;
+static bool classHierarchyScanned = false;
+
+static void scanClassHierarchy(Dsymbols* members)
+{
+    if (!members)
+        return;
+
+    for (unsigned i = 0; i < members->dim; i++)
+    {
+        Dsymbol* s = members->tdata()[i];
+        if (AttribDeclaration* ad = s->isAttribDeclaration())
+        {
+            scanClassHierarchy(ad->include(NULL, NULL));
+        }
+        else if (TemplateInstance* ti = s->isTemplateInstance())
+        {
+            if (!ti->errors)
+                scanClassHierarchy(ti->members);
+        }
+        else if (AggregateDeclaration* agg = s->isAggregateDeclaration())
+        {
+            if (ClassDeclaration* cd = agg->isClassDeclaration())
+            {
+                for (unsigned j = 0; j < cd->vtbl.dim; j++)
+                {
+                    FuncDeclaration* fd = cd->vtbl.tdata()[j]->isFuncDeclaration();
+                    if (!fd || fd->toParent() != cd)
+                        continue;
+                    for (unsigned k = 0; k < fd->foverrides.dim; k++)
+                        overriddenFuncs.insert(fd->foverrides.tdata()[k]);
+                }
+            }
+            scanClassHierarchy(agg->members);
+        }
+    }
+}
+
+bool DtoHasKnownOverride(FuncDeclaration* fd)
+{
+    // classes local to functions are not found, but the calls we
+    // devirtualize based on this are guarded anyway
+    if (!classHierarchyScanned)
+    {
+        for (unsigned i = 0; i < Module::amodules.dim; i++)
+            scanClassHierarchy(Module::amodules.tdata()[i]->members);
+        classHierarchyScanned = true;
+    }
+    return overriddenFuncs.count(fd) != 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
 #if GENERATE_OFFTI
 
 // build a single element for the OffsetInfo[] of ClassInfo
@@ -563,7 +758,7 @@ static LLConstant* build_offti_entry(ClassDeclaration* cd, VarDeclaration* vd)
     offset += vd->ir.irField->unionOffset;
 
     // assert that it matches DMD
-    Logger::println("offsets: %lu vs %u", offset, vd->offset);
+    IF_LOG Logger::println("offsets: %lu vs %u", offset, vd->offset);
     assert(offset == vd->offset);
 
     inits[0] = DtoConstSize_t(offset);
@@ -681,7 +876,7 @@ LLConstant* DtoDefineClassInfo(ClassDeclaration* cd)
 //              TypeInfo typeinfo; // since dmd 1.045
 //        }
 
-    Logger::println("DtoDefineClassInfo(%s)", cd->toChars());
+    IF_LOG Logger::println("DtoDefineClassInfo(%s)", cd->toChars());
     LOG_SCOPE;
 
     assert(cd->type->ty == Tclass);
@@ -805,7 +1000,7 @@ LLConstant* DtoDefineClassInfo(ClassDeclaration* cd)
     /*size_t n = inits.size();
     for (size_t i=0; i<n; ++i)
     {
-        Logger::cout() << "inits[" << i << "]: " << *inits[i] << '\n';
+        IF_LOG Logger::cout() << "inits[" << i << "]: " << *inits[i] << '\n';
     }*/
 
     // build the initializer
@@ -34,4 +34,11 @@ LLValue* DtoIndexClass(LLValue* src, ClassDeclaration* sd, VarDeclaration* vd);
 
 LLValue* DtoVirtualFunctionPointer(DValue* inst, FuncDeclaration* fdecl, char* name);
 
+/// Returns the function a call of the virtual function fdecl dispatches to
+/// for objects of exactly class cd, or NULL if there is none.
+FuncDeclaration* DtoVirtualFunctionTarget(ClassDeclaration* cd, FuncDeclaration* fdecl);
+
+/// Returns true if any class known to this compilation overrides fd.
+bool DtoHasKnownOverride(FuncDeclaration* fd);
+
 #endif
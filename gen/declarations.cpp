@@ -23,14 +23,14 @@
 
 void Dsymbol::codegen(Ir*)
 {
-    Logger::println("Ignoring Dsymbol::toObjFile for %s", toChars());
+    IF_LOG Logger::println("Ignoring Dsymbol::toObjFile for %s", toChars());
 }
 
 /* ================================================================== */
 
 void Declaration::codegen(Ir*)
 {
-    Logger::println("Ignoring Declaration::toObjFile for %s", toChars());
+    IF_LOG Logger::println("Ignoring Declaration::toObjFile for %s", toChars());
 }
 
 /* ================================================================== */
@@ -76,7 +76,7 @@ void ClassDeclaration::codegen(Ir*)
 
 void TupleDeclaration::codegen(Ir* p)
 {
-    Logger::println("TupleDeclaration::toObjFile(): %s", toChars());
+    IF_LOG Logger::println("TupleDeclaration::toObjFile(): %s", toChars());
 
     assert(isexp);
     assert(objects);
@@ -97,7 +97,7 @@ void TupleDeclaration::codegen(Ir* p)
 
 void VarDeclaration::codegen(Ir* p)
 {
-    Logger::print("VarDeclaration::toObjFile(): %s | %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("VarDeclaration::toObjFile(): %s | %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     if (type->ty == Terror)
@@ -108,7 +108,7 @@ void VarDeclaration::codegen(Ir* p)
     // just forward aliases
     if (aliassym)
     {
-        Logger::println("alias sym");
+        IF_LOG Logger::println("alias sym");
         toAlias()->codegen(p);
         return;
     }
@@ -125,7 +125,7 @@ void VarDeclaration::codegen(Ir* p)
     if (isDataseg())
 #endif
     {
-        Logger::println("data segment");
+        IF_LOG Logger::println("data segment");
 
     #if DMDV2 && 0 // TODO:
         if (storage_class & STCmanifest)
@@ -141,7 +141,7 @@ void VarDeclaration::codegen(Ir* p)
 
         this->ir.irGlobal = new IrGlobal(this);
 
-        Logger::println("parent: %s (%s)", parent->toChars(), parent->kind());
+        IF_LOG Logger::println("parent: %s (%s)", parent->toChars(), parent->kind());
 
     #if DMDV2
         // not sure why this is only needed for d2
@@ -150,7 +150,7 @@ void VarDeclaration::codegen(Ir* p)
         bool _isconst = isConst();
     #endif
 
-        Logger::println("Creating global variable");
+        IF_LOG Logger::println("Creating global variable");
 
         assert(!ir.initialized);
         ir.initialized = gIR->dmodule;
@@ -179,10 +179,10 @@ void VarDeclaration::codegen(Ir* p)
         {
             if (Logger::enabled())
             {
-                Logger::println("setting initializer");
-                Logger::cout() << "global: " << *gvar << '\n';
+                IF_LOG Logger::println("setting initializer");
+                IF_LOG Logger::cout() << "global: " << *gvar << '\n';
     #if 0
-                Logger::cout() << "init:   " << *initVal << '\n';
+                IF_LOG Logger::cout() << "init:   " << *initVal << '\n';
     #endif
             }
             // build the initializer
@@ -203,7 +203,7 @@ void VarDeclaration::codegen(Ir* p)
 
 void TypedefDeclaration::codegen(Ir*)
 {
-    Logger::print("TypedefDeclaration::toObjFile: %s\n", toChars());
+    IF_LOG Logger::print("TypedefDeclaration::toObjFile: %s\n", toChars());
     LOG_SCOPE;
 
     if (type->ty == Terror)
@@ -219,7 +219,7 @@ void TypedefDeclaration::codegen(Ir*)
 
 void EnumDeclaration::codegen(Ir*)
 {
-    Logger::println("Ignoring EnumDeclaration::toObjFile for %s", toChars());
+    IF_LOG Logger::println("Ignoring EnumDeclaration::toObjFile for %s", toChars());
 
     if (type->ty == Terror)
     {   error("had semantic errors when compiling");
@@ -53,7 +53,7 @@ LLValue* DSliceValue::getRVal()
 /////////////////////////////////////////////////////////////////////////////////////////////////
 
 DFuncValue::DFuncValue(FuncDeclaration* fd, LLValue* v, LLValue* vt)
-: DValue(fd->type), func(fd), val(v), vthis(vt)
+: DValue(fd->type), func(fd), val(v), vthis(vt), speculativeTarget(0)
 {}
 
 LLValue* DFuncValue::getRVal()
@@ -129,6 +129,9 @@ struct DFuncValue : DValue
     FuncDeclaration* func;
     llvm::Value* val;
     llvm::Value* vthis;
+    // if set, val is a vtbl slot likely holding this function, which is
+    // then called directly
+    llvm::Value* speculativeTarget;
 
     DFuncValue(FuncDeclaration* fd, llvm::Value* v, llvm::Value* vt = 0);
 
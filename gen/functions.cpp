@@ -153,7 +153,7 @@ llvm::FunctionType* DtoFunctionType(Type* type, Type* thistype, Type* nesttype,
         // handle lazy args
         if (arg->storageClass & STClazy)
         {
-            Logger::println("lazy param");
+            IF_LOG Logger::println("lazy param");
             TypeFunction *ltf = new TypeFunction(NULL, arg->type, 0, LINKd);
             TypeDelegate *ltd = new TypeDelegate(ltf);
             argtype = ltd;
@@ -209,7 +209,7 @@ llvm::FunctionType* DtoFunctionType(Type* type, Type* thistype, Type* nesttype,
 
     LLFunctionType* functype = LLFunctionType::get(f->fty.ret->ltype, argtypes, f->fty.c_vararg);
 
-    Logger::cout() << "Final function type: " << *functype << "\n";
+    IF_LOG Logger::cout() << "Final function type: " << *functype << "\n";
 
     return functype;
 }
@@ -261,7 +261,7 @@ llvm::FunctionType* DtoFunctionType(FuncDeclaration* fdecl)
 #endif
     if (fdecl->needThis()) {
         if (AggregateDeclaration* ad = fdecl->isMember2()) {
-            Logger::println("isMember = this is: %s", ad->type->toChars());
+            IF_LOG Logger::println("isMember = this is: %s", ad->type->toChars());
             dthis = ad->type;
             LLType* thisty = DtoType(dthis);
             //Logger::cout() << "this llvm type: " << *thisty << '\n';
@@ -269,7 +269,7 @@ llvm::FunctionType* DtoFunctionType(FuncDeclaration* fdecl)
                 thisty = getPtrToType(thisty);
         }
         else {
-            Logger::println("chars: %s type: %s kind: %s", fdecl->toChars(), fdecl->type->toChars(), fdecl->kind());
+            IF_LOG Logger::println("chars: %s type: %s kind: %s", fdecl->toChars(), fdecl->type->toChars(), fdecl->kind());
             assert(0);
         }
     }
@@ -306,7 +306,7 @@ static llvm::Function* DtoDeclareVaFunction(FuncDeclaration* fdecl)
 void DtoResolveFunction(FuncDeclaration* fdecl)
 {
     if ((!global.params.useUnitTests || !fdecl->type) && fdecl->isUnitTestDeclaration()) {
-        Logger::println("Ignoring unittest %s", fdecl->toPrettyChars());
+        IF_LOG Logger::println("Ignoring unittest %s", fdecl->toPrettyChars());
         return; // ignore declaration completely
     }
 
@@ -329,7 +329,7 @@ void DtoResolveFunction(FuncDeclaration* fdecl)
         TemplateDeclaration* tempdecl = tinst->tempdecl;
         if (tempdecl->llvmInternal == LLVMva_arg)
         {
-            Logger::println("magic va_arg found");
+            IF_LOG Logger::println("magic va_arg found");
             fdecl->llvmInternal = LLVMva_arg;
             fdecl->ir.resolved = true;
             fdecl->ir.declared = true;
@@ -339,12 +339,12 @@ void DtoResolveFunction(FuncDeclaration* fdecl)
         }
         else if (tempdecl->llvmInternal == LLVMva_start)
         {
-            Logger::println("magic va_start found");
+            IF_LOG Logger::println("magic va_start found");
             fdecl->llvmInternal = LLVMva_start;
         }
         else if (tempdecl->llvmInternal == LLVMintrinsic)
         {
-            Logger::println("overloaded intrinsic found");
+            IF_LOG Logger::println("overloaded intrinsic found");
             fdecl->llvmInternal = LLVMintrinsic;
             DtoOverloadedIntrinsicName(tinst, tempdecl, fdecl->intrinsicName);
             fdecl->linkage = LINKintrinsic;
@@ -352,7 +352,7 @@ void DtoResolveFunction(FuncDeclaration* fdecl)
         }
         else if (tempdecl->llvmInternal == LLVMinline_asm)
         {
-            Logger::println("magic inline asm found");
+            IF_LOG Logger::println("magic inline asm found");
             TypeFunction* tf = (TypeFunction*)fdecl->type;
             if (tf->varargs != 1 || (fdecl->parameters && fdecl->parameters->dim != 0))
             {
@@ -370,7 +370,7 @@ void DtoResolveFunction(FuncDeclaration* fdecl)
 
     DtoType(fdecl->type);
 
-    Logger::println("DtoResolveFunction(%s): %s", fdecl->toPrettyChars(), fdecl->loc.toChars());
+    IF_LOG Logger::println("DtoResolveFunction(%s): %s", fdecl->toPrettyChars(), fdecl->loc.toChars());
     LOG_SCOPE;
 
     // queue declaration unless the function is abstract without body
@@ -382,6 +382,44 @@ void DtoResolveFunction(FuncDeclaration* fdecl)
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
+unsigned DtoFunctionAttrs(TypeFunction* f)
+{
+    unsigned attrs = 0;
+#if DMDV2
+    if (f->linkage == LINKintrinsic)
+        return attrs;
+
+    // nothrow functions may only throw Errors, which are not recoverable,
+    // so there is no need to unwind through calls to them
+    if (f->isnothrow)
+        attrs |= NoUnwind;
+
+    // The result of a strongly pure function only depends on its arguments.
+    // It must not return references though, since two calls would then
+    // yield different (freshly allocated) memory.
+    if (!f->isnothrow || f->purity != PUREstrong || f->isref || f->varargs ||
+        f->fty.arg_sret || f->fty.arg_this || f->fty.arg_nest ||
+        f->next->toBasetype()->hasPointers())
+        return attrs;
+
+    bool readnone = true;
+    size_t n = Parameter::dim(f->parameters);
+    for (size_t i = 0; i < n; ++i)
+    {
+        Parameter* arg = Parameter::getNth(f->parameters, i);
+        if (arg->storageClass & (STCref | STCout | STClazy))
+            return attrs;
+        // immutable data reachable from the arguments is still read
+        if (f->fty.args[i]->byref || arg->type->hasPointers())
+            readnone = false;
+    }
+    attrs |= readnone ? ReadNone : ReadOnly;
+#endif
+    return attrs;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
 static void set_param_attrs(TypeFunction* f, llvm::Function* func, FuncDeclaration* fdecl)
 {
     LLSmallVector<llvm::AttributeWithIndex, 9> attrs;
@@ -438,6 +476,13 @@ static void set_param_attrs(TypeFunction* f, llvm::Function* func, FuncDeclarati
         }
     }
 
+    // function attributes
+    // Errors thrown by asserts and bounds checks unwind through nothrow
+    // functions too, so they always need unwind tables.
+    PAWI.Index = ~0U;
+    PAWI.Attrs = DtoFunctionAttrs(f) | llvm::Attribute::UWTable;
+    attrs.push_back(PAWI);
+
     llvm::AttrListPtr attrlist = llvm::AttrListPtr::get(attrs.begin(), attrs.end());
     func->setAttributes(attrlist);
 }
@@ -451,7 +496,7 @@ void DtoDeclareFunction(FuncDeclaration* fdecl)
     if (fdecl->ir.declared) return;
     fdecl->ir.declared = true;
 
-    Logger::println("DtoDeclareFunction(%s): %s", fdecl->toPrettyChars(), fdecl->loc.toChars());
+    IF_LOG Logger::println("DtoDeclareFunction(%s): %s", fdecl->toPrettyChars(), fdecl->loc.toChars());
     LOG_SCOPE;
 
     //printf("declare function: %s\n", fdecl->toPrettyChars());
@@ -669,7 +714,7 @@ void DtoDefineFunction(FuncDeclaration* fd)
     if (fd->fbody == NULL)
         return;
 
-    Logger::println("Doing function body for: %s", fd->toChars());
+    IF_LOG Logger::println("Doing function body for: %s", fd->toChars());
     assert(fd->ir.irFunc);
     IrFunction* irfunction = fd->ir.irFunc;
     gIR->functions.push_back(irfunction);
@@ -787,12 +832,12 @@ void DtoDefineFunction(FuncDeclaration* fd)
 #if DMDV1
     // need result variable? (nested)
     if (fd->vresult && fd->vresult->nestedref) {
-        Logger::println("nested vresult value: %s", fd->vresult->toChars());
+        IF_LOG Logger::println("nested vresult value: %s", fd->vresult->toChars());
         fd->nestedVars.insert(fd->vresult);
     }
 
     if (fd->vthis && fd->vthis->nestedref && !fd->nestedVars.empty()) {
-        Logger::println("nested vthis value: %s", fd->vthis->toChars());
+        IF_LOG Logger::println("nested vthis value: %s", fd->vthis->toChars());
         fd->nestedVars.insert(fd->vthis);
     }
 #endif
@@ -916,7 +961,7 @@ llvm::FunctionType* DtoBaseFunctionType(FuncDeclaration* fdecl)
 
 DValue* DtoArgument(Parameter* fnarg, Expression* argexp)
 {
-    Logger::println("DtoArgument");
+    IF_LOG Logger::println("DtoArgument");
     LOG_SCOPE;
 
     DValue* arg = argexp->toElem(gIR);
@@ -950,7 +995,7 @@ DValue* DtoArgument(Parameter* fnarg, Expression* argexp)
 
 void DtoVariadicArgument(Expression* argexp, LLValue* dst)
 {
-    Logger::println("DtoVariadicArgument");
+    IF_LOG Logger::println("DtoVariadicArgument");
     LOG_SCOPE;
     DVarValue vv(argexp->type, dst);
     DtoAssign(argexp->loc, &vv, argexp->toElem(gIR));
@@ -5,6 +5,7 @@
 
 struct FuncDeclaration;
 struct Type;
+struct TypeFunction;
 
 struct IRAsmBlock;
 
@@ -18,6 +19,10 @@ llvm::FunctionType* DtoFunctionType(FuncDeclaration* fdecl);
 
 llvm::FunctionType* DtoBaseFunctionType(FuncDeclaration* fdecl);
 
+// Returns the LLVM function attributes implied by the D attributes of f,
+// whose IrFuncTy must already have been built.
+unsigned DtoFunctionAttrs(TypeFunction* f);
+
 void DtoResolveFunction(FuncDeclaration* fdecl);
 void DtoDeclareFunction(FuncDeclaration* fdecl);
 void DtoDefineFunction(FuncDeclaration* fd);
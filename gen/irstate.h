@@ -149,7 +149,7 @@ struct IRState
     // create a call or invoke, depending on the landing pad info
     // the template function is defined further down in this file
     template <typename T>
-    llvm::CallSite CreateCallOrInvoke(LLValue* Callee, const T& args, const char* Name="");
+    llvm::CallSite CreateCallOrInvoke(LLValue* Callee, const T& args, const char* Name="", bool isNothrow=false);
     llvm::CallSite CreateCallOrInvoke(LLValue* Callee, const char* Name="");
     llvm::CallSite CreateCallOrInvoke(LLValue* Callee, LLValue* Arg1, const char* Name="");
     llvm::CallSite CreateCallOrInvoke2(LLValue* Callee, LLValue* Arg1, LLValue* Arg2, const char* Name="");
@@ -197,17 +197,18 @@ struct IRState
 };
 
 template <typename T>
-llvm::CallSite IRState::CreateCallOrInvoke(LLValue* Callee, const T &args, const char* Name)
+llvm::CallSite IRState::CreateCallOrInvoke(LLValue* Callee, const T &args, const char* Name, bool isNothrow)
 {
     llvm::BasicBlock* pad = func()->gen->landingPad;
     if(pad)
     {
         // intrinsics don't support invoking and 'nounwind' functions don't need it.
         LLFunction* funcval = llvm::dyn_cast<LLFunction>(Callee);
-        if (funcval && (funcval->isIntrinsic() || funcval->doesNotThrow()))
+        if (isNothrow || (funcval && (funcval->isIntrinsic() || funcval->doesNotThrow())))
         {
             llvm::CallInst* call = ir->CreateCall(Callee, args, Name);
-            call->setAttributes(funcval->getAttributes());
+            if (funcval)
+                call->setAttributes(funcval->getAttributes());
             return call;
         }
 
@@ -7,9 +7,11 @@
 #include "expression.h"
 #include "template.h"
 #include "module.h"
+#include "lexer.h"
 
 #include "llvm/MC/MCAsmInfo.h"
 #include "llvm/Target/TargetMachine.h"
+#include "llvm/Support/CommandLine.h"
 
 #include "gen/tollvm.h"
 #include "gen/irstate.h"
@@ -27,6 +29,11 @@
 
 #include <stack>
 
+static llvm::cl::opt<bool> duplicateFinally("duplicate-finally",
+    llvm::cl::desc("Emit a copy of the finally block for every jump out of a try block"),
+    llvm::cl::Hidden,
+    llvm::cl::ZeroOrMore);
+
 /****************************************************************************************/
 /*////////////////////////////////////////////////////////////////////////////////////////
 // DYNAMIC MEMORY HELPERS
@@ -293,13 +300,29 @@ void EnclosingVolatile::emitCode(IRState * p)
 
 void EnclosingTryFinally::emitCode(IRState * p)
 {
-    if (tf->finalbody)
+    if (!tf->finalbody)
+        return;
+
+    if (duplicateFinally)
     {
         llvm::BasicBlock* oldpad = p->func()->gen->landingPad;
         p->func()->gen->landingPad = landingPad;
         tf->finalbody->toIR(p);
         p->func()->gen->landingPad = oldpad;
+        return;
     }
+
+    // run the shared finally block, which dispatches back to a new block
+    // the rest of the jump is emitted into
+    if (!selector)
+        selector = DtoRawAlloca(LLType::getInt32Ty(p->context()), 0, "finally.selector");
+
+    llvm::BasicBlock* contbb = llvm::BasicBlock::Create(p->context(), "finally.cont", p->topfunc(), p->scopeend());
+    continuations.push_back(contbb);
+    DtoStore(DtoConstUint(continuations.size()), selector);
+    llvm::BranchInst::Create(finallyBB, p->scopebb());
+
+    p->scope() = IRScope(contbb, p->scopeend());
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////
@@ -386,7 +409,7 @@ void DtoLeaveMonitor(LLValue* v)
 
 void DtoAssign(Loc& loc, DValue* lhs, DValue* rhs, int op)
 {
-    Logger::println("DtoAssign(...);\n");
+    IF_LOG Logger::println("DtoAssign(...);\n");
     LOG_SCOPE;
 
     Type* t = lhs->getType()->toBasetype();
@@ -483,8 +506,8 @@ void DtoAssign(Loc& loc, DValue* lhs, DValue* rhs, int op)
         LLValue* r = rhs->getRVal();
         if (Logger::enabled())
         {
-            Logger::cout() << "l : " << *l << '\n';
-            Logger::cout() << "r : " << *r << '\n';
+            IF_LOG Logger::cout() << "l : " << *l << '\n';
+            IF_LOG Logger::cout() << "r : " << *r << '\n';
         }
         r = DtoBitCast(r, l->getType()->getContainedType(0));
         DtoStore(r, l);
@@ -812,7 +835,7 @@ DValue* DtoCast(Loc& loc, DValue* val, Type* to)
     if (fromtype->equals(totype))
         return val;
 
-    Logger::println("Casting from '%s' to '%s'", fromtype->toChars(), to->toChars());
+    IF_LOG Logger::println("Casting from '%s' to '%s'", fromtype->toChars(), to->toChars());
     LOG_SCOPE;
 
 #if DMDV2
@@ -858,7 +881,7 @@ DValue* DtoCast(Loc& loc, DValue* val, Type* to)
 DValue* DtoPaintType(Loc& loc, DValue* val, Type* to)
 {
     Type* from = val->getType()->toBasetype();
-    Logger::println("repainting from '%s' to '%s'", from->toChars(), to->toChars());
+    IF_LOG Logger::println("repainting from '%s' to '%s'", from->toChars(), to->toChars());
 
     if (from->ty == Tarray)
     {
@@ -973,7 +996,7 @@ void DtoConstInitGlobal(VarDeclaration* vd)
     if (vd->ir.initialized) return;
     vd->ir.initialized = gIR->dmodule;
 
-    Logger::println("DtoConstInitGlobal(%s) @ %s", vd->toChars(), vd->loc.toChars());
+    IF_LOG Logger::println("DtoConstInitGlobal(%s) @ %s", vd->toChars(), vd->loc.toChars());
     LOG_SCOPE;
 
     // build the initializer
@@ -995,10 +1018,10 @@ void DtoConstInitGlobal(VarDeclaration* vd)
     {
         if (Logger::enabled())
         {
-            Logger::println("setting initializer");
-            Logger::cout() << "global: " << *gvar << '\n';
+            IF_LOG Logger::println("setting initializer");
+            IF_LOG Logger::cout() << "global: " << *gvar << '\n';
 #if 0
-            Logger::cout() << "init:   " << *initVal << '\n';
+            IF_LOG Logger::cout() << "init:   " << *initVal << '\n';
 #endif
         }
 
@@ -1015,13 +1038,13 @@ void DtoConstInitGlobal(VarDeclaration* vd)
 ////////////////////////////////////////////////////////////////////////////////////////*/
 DValue* DtoDeclarationExp(Dsymbol* declaration)
 {
-    Logger::print("DtoDeclarationExp: %s\n", declaration->toChars());
+    IF_LOG Logger::print("DtoDeclarationExp: %s\n", declaration->toChars());
     LOG_SCOPE;
 
     // variable declaration
     if (VarDeclaration* vd = declaration->isVarDeclaration())
     {
-        Logger::println("VarDeclaration");
+        IF_LOG Logger::println("VarDeclaration");
 
         // if aliassym is set, this VarDecl is redone as an alias to another symbol
         // this seems to be done to rewrite Tuple!(...) v;
@@ -1039,7 +1062,7 @@ DValue* DtoDeclarationExp(Dsymbol* declaration)
             if (global.params.llvmAnnotate)
                 DtoAnnotation(declaration->toChars());
 
-            Logger::println("vdtype = %s", vd->type->toChars());
+            IF_LOG Logger::println("vdtype = %s", vd->type->toChars());
 
             // ref vardecls are generated when DMD lowers foreach to a for statement,
             // and this is a hack to support them for this case only
@@ -1072,7 +1095,7 @@ DValue* DtoDeclarationExp(Dsymbol* declaration)
         #else
             if (vd->nestedref) {
         #endif
-                Logger::println("has nestedref set");
+                IF_LOG Logger::println("has nestedref set");
                 assert(vd->ir.irLocal);
                 DtoNestedInit(vd);
             // is it already allocated?
@@ -1158,43 +1181,43 @@ DValue* DtoDeclarationExp(Dsymbol* declaration)
     // struct declaration
     else if (StructDeclaration* s = declaration->isStructDeclaration())
     {
-        Logger::println("StructDeclaration");
+        IF_LOG Logger::println("StructDeclaration");
         s->codegen(Type::sir);
     }
     // function declaration
     else if (FuncDeclaration* f = declaration->isFuncDeclaration())
     {
-        Logger::println("FuncDeclaration");
+        IF_LOG Logger::println("FuncDeclaration");
         f->codegen(Type::sir);
     }
     // alias declaration
     else if (declaration->isAliasDeclaration())
     {
-        Logger::println("AliasDeclaration - no work");
+        IF_LOG Logger::println("AliasDeclaration - no work");
         // do nothing
     }
     // enum
     else if (declaration->isEnumDeclaration())
     {
-        Logger::println("EnumDeclaration - no work");
+        IF_LOG Logger::println("EnumDeclaration - no work");
         // do nothing
     }
     // class
     else if (ClassDeclaration* e = declaration->isClassDeclaration())
     {
-        Logger::println("ClassDeclaration");
+        IF_LOG Logger::println("ClassDeclaration");
         e->codegen(Type::sir);
     }
     // typedef
     else if (TypedefDeclaration* tdef = declaration->isTypedefDeclaration())
     {
-        Logger::println("TypedefDeclaration");
+        IF_LOG Logger::println("TypedefDeclaration");
         DtoTypeInfoOf(tdef->type, false);
     }
     // attribute declaration
     else if (AttribDeclaration* a = declaration->isAttribDeclaration())
     {
-        Logger::println("AttribDeclaration");
+        IF_LOG Logger::println("AttribDeclaration");
         // choose the right set in case this is a conditional declaration
         Array *d = a->include(NULL, NULL);
         if (d)
@@ -1206,7 +1229,7 @@ DValue* DtoDeclarationExp(Dsymbol* declaration)
     // mixin declaration
     else if (TemplateMixin* m = declaration->isTemplateMixin())
     {
-        Logger::println("TemplateMixin");
+        IF_LOG Logger::println("TemplateMixin");
         for (unsigned i=0; i < m->members->dim; ++i)
         {
             Dsymbol* mdsym = (Dsymbol*)m->members->data[i];
@@ -1216,7 +1239,7 @@ DValue* DtoDeclarationExp(Dsymbol* declaration)
     // tuple declaration
     else if (TupleDeclaration* tupled = declaration->isTupleDeclaration())
     {
-        Logger::println("TupleDeclaration");
+        IF_LOG Logger::println("TupleDeclaration");
         if(!tupled->isexp) {
             error(declaration->loc, "don't know how to handle non-expression tuple decls yet");
             assert(0);
@@ -1232,7 +1255,7 @@ DValue* DtoDeclarationExp(Dsymbol* declaration)
     // template
     else if (TemplateDeclaration* t = declaration->isTemplateDeclaration())
     {
-        Logger::println("TemplateDeclaration");
+        IF_LOG Logger::println("TemplateDeclaration");
         // do nothing
     }
     // unsupported declaration
@@ -1374,33 +1397,33 @@ LLConstant* DtoConstInitializer(Loc loc, Type* type, Initializer* init)
     LLConstant* _init = 0; // may return zero
     if (!init)
     {
-        Logger::println("const default initializer for %s", type->toChars());
+        IF_LOG Logger::println("const default initializer for %s", type->toChars());
         _init = DtoConstExpInit(loc, type, type->defaultInit());
     }
     else if (ExpInitializer* ex = init->isExpInitializer())
     {
-        Logger::println("const expression initializer");
+        IF_LOG Logger::println("const expression initializer");
         _init = DtoConstExpInit(loc, type, ex->exp);
     }
     else if (StructInitializer* si = init->isStructInitializer())
     {
-        Logger::println("const struct initializer");
+        IF_LOG Logger::println("const struct initializer");
         si->ad->codegen(Type::sir);
         return si->ad->ir.irStruct->createStructInitializer(si);
     }
     else if (ArrayInitializer* ai = init->isArrayInitializer())
     {
-        Logger::println("const array initializer");
+        IF_LOG Logger::println("const array initializer");
         _init = DtoConstArrayInitializer(ai);
     }
     else if (init->isVoidInitializer())
     {
-        Logger::println("const void initializer");
+        IF_LOG Logger::println("const void initializer");
         LLType* ty = DtoTypeNotVoid(type);
         _init = LLConstant::getNullValue(ty);
     }
     else {
-        Logger::println("unsupported const initializer: %s", init->toChars());
+        IF_LOG Logger::println("unsupported const initializer: %s", init->toChars());
     }
     return _init;
 }
@@ -1413,7 +1436,7 @@ DValue* DtoInitializer(LLValue* target, Initializer* init)
         return 0;
     else if (ExpInitializer* ex = init->isExpInitializer())
     {
-        Logger::println("expression initializer");
+        IF_LOG Logger::println("expression initializer");
         assert(ex->exp);
         return ex->exp->toElem(gIR);
     }
@@ -1429,7 +1452,7 @@ DValue* DtoInitializer(LLValue* target, Initializer* init)
         // TODO: again nothing ?
     }
     else {
-        Logger::println("unsupported initializer: %s", init->toChars());
+        IF_LOG Logger::println("unsupported initializer: %s", init->toChars());
         assert(0);
     }
     return 0;
@@ -1439,7 +1462,7 @@ DValue* DtoInitializer(LLValue* target, Initializer* init)
 
 static LLConstant* expand_to_sarray(Type *base, Expression* exp)
 {
-    Logger::println("building type %s from expression (%s) of type %s", base->toChars(), exp->toChars(), exp->type->toChars());
+    IF_LOG Logger::println("building type %s from expression (%s) of type %s", base->toChars(), exp->toChars(), exp->type->toChars());
     LLType* dstTy = DtoType(base);
     if (Logger::enabled())
         Logger::cout() << "final llvm type requested: " << *dstTy << '\n';
@@ -1447,14 +1470,14 @@ static LLConstant* expand_to_sarray(Type *base, Expression* exp)
     LLConstant* val = exp->toConstElem(gIR);
 
     Type* expbase = stripModifiers(exp->type->toBasetype());
-    Logger::println("expbase: %s", expbase->toChars());
+    IF_LOG Logger::println("expbase: %s", expbase->toChars());
     Type* t = base->toBasetype();
 
     LLSmallVector<size_t, 4> dims;
 
     while(1)
     {
-        Logger::println("t: %s", t->toChars());
+        IF_LOG Logger::println("t: %s", t->toChars());
         if (t->equals(expbase))
             break;
         assert(t->ty == Tsarray);
@@ -1498,7 +1521,7 @@ LLConstant* DtoConstExpInit(Loc loc, Type* type, Expression* exp)
                 error(loc, "static arrays of voids have no default initializer");
                 fatal();
             }
-            Logger::println("type is a static array, building constant array initializer to single value");
+            IF_LOG Logger::println("type is a static array, building constant array initializer to single value");
             return expand_to_sarray(base, exp);
         }
         else
@@ -1552,12 +1575,12 @@ LLConstant* DtoTypeInfoOf(Type* type, bool base)
 
 void DtoOverloadedIntrinsicName(TemplateInstance* ti, TemplateDeclaration* td, std::string& name)
 {
-    Logger::println("DtoOverloadedIntrinsicName");
+    IF_LOG Logger::println("DtoOverloadedIntrinsicName");
     LOG_SCOPE;
 
-    Logger::println("template instance: %s", ti->toChars());
-    Logger::println("template declaration: %s", td->toChars());
-    Logger::println("intrinsic name: %s", td->intrinsicName.c_str());
+    IF_LOG Logger::println("template instance: %s", ti->toChars());
+    IF_LOG Logger::println("template declaration: %s", td->toChars());
+    IF_LOG Logger::println("intrinsic name: %s", td->intrinsicName.c_str());
 
     // for now use the size in bits of the first template param in the instance
     assert(ti->tdtypes.dim == 1);
@@ -1595,18 +1618,58 @@ void DtoOverloadedIntrinsicName(TemplateInstance* ti, TemplateDeclaration* td, s
         }
     }
 
-    Logger::println("final intrinsic name: %s", name.c_str());
+    IF_LOG Logger::println("final intrinsic name: %s", name.c_str());
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
+// Functions longer than this many source lines are never inlined across
+// modules, so don't bother running semantic3 on them.
+static const unsigned maxLazyInlineLines = 30;
+
+/// Runs semantic3 on a function of an imported module when code generation
+/// first references it, so that it can be emitted available_externally for
+/// the inliner. Returns false if the function isn't a candidate.
+static bool semantic3ForInlining(FuncDeclaration* fd)
+{
+    if (!global.params.useAvailableExternally || !fd->availableExternally)
+        return false;
+    if (!fd->fbody || !fd->scope || fd->semanticRun < PASSsemanticdone)
+        return false;
+
+    // nested functions are analyzed along with their parent
+    if (fd->toParent2()->isFuncDeclaration())
+        return false;
+    if (fd->isStaticCtorDeclaration() || fd->isStaticDtorDeclaration() ||
+        fd->isUnitTestDeclaration())
+        return false;
+    // calls through the vtable won't be inlined
+    if (fd->isVirtual() && !fd->isFinal())
+        return false;
+
+    Module* m = fd->getModule();
+    if (!m || m->isRoot)
+        return false;
+
+    // cheap size estimate, canInline() decides once the body is analyzed
+    if (fd->endloc.linnum < fd->loc.linnum ||
+        fd->endloc.linnum - fd->loc.linnum > maxLazyInlineLines)
+        return false;
+
+    IF_LOG Logger::println("Running semantic3 for inlining: %s", fd->toPrettyChars());
+    if (global.params.verbose)
+        printf("semantic3 %s\n", fd->toPrettyChars());
+    fd->semantic3(fd->scope);
+    return !fd->semantic3Errors;
+}
+
 bool mustDefineSymbol(Dsymbol* s)
 {
     if (FuncDeclaration* fd = s->isFuncDeclaration())
     {
         // we can't (and probably shouldn't?) define functions
         // that weren't semantic3'ed
-        if (fd->semanticRun < 4)
+        if (fd->semanticRun < 4 && !semantic3ForInlining(fd))
             return false;
 
         if (fd->isArrayOp == 1)
@@ -1657,15 +1720,29 @@ bool mustDefineSymbol(Dsymbol* s)
     TemplateInstance* tinst = DtoIsTemplateInstance(s);
     if (tinst)
     {
-        if (!global.params.singleObj)
+        if (!global.params.singleObj && !global.params.templatesOnce)
             return true;
 
+        // the first module referencing an instance emits all of it,
+        // the other modules of this build only declare its symbols
         if (!tinst->emittedInModule)
         {
             gIR->seenTemplateInstances.insert(tinst);
             tinst->emittedInModule = gIR->dmodule;
         }
-        return tinst->emittedInModule == gIR->dmodule;
+        if (tinst->emittedInModule == gIR->dmodule)
+            return true;
+
+        // but keep small functions around for the inliner
+        if (!global.params.singleObj && global.params.useAvailableExternally)
+        {
+            FuncDeclaration* fd = s->isFuncDeclaration();
+            if (fd && !fd->isStaticCtorDeclaration()
+                   && !fd->isStaticDtorDeclaration()
+                   && fd->canInline(true))
+                return true;
+        }
+        return false;
     }
 
     return s->getModule() == gIR->dmodule;
@@ -1673,6 +1750,16 @@ bool mustDefineSymbol(Dsymbol* s)
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
+bool isTemplateInstanceOwnedElsewhere(Dsymbol* s)
+{
+    if (global.params.singleObj || !global.params.templatesOnce)
+        return false;
+    TemplateInstance* tinst = DtoIsTemplateInstance(s);
+    return tinst && tinst->emittedInModule && tinst->emittedInModule != gIR->dmodule;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
 bool needsTemplateLinkage(Dsymbol* s)
 {
     return DtoIsTemplateInstance(s) && mustDefineSymbol(s);
@@ -1890,6 +1977,16 @@ LLValue* makeLValue(Loc& loc, DValue* value)
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
+Expression* DtoLvalueExp(Loc& loc, Type* type, LLValue* addr)
+{
+    VarDeclaration* var = new VarDeclaration(loc, type, Lexer::uniqueId("__tmp"), NULL);
+    Expression* e = new VarExp(loc, var);
+    e->cachedLvalue = addr;
+    return e;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
 #if DMDV2
 void callPostblit(Loc &loc, Expression *exp, LLValue *val)
 {
@@ -7,6 +7,8 @@
 #include "statement.h"
 #include "mtype.h"
 
+#include <vector>
+
 // this is used for tracking try-finally, synchronized and volatile scopes
 struct EnclosingHandler
 {
@@ -16,9 +18,15 @@ struct EnclosingTryFinally : EnclosingHandler
 {
     TryFinallyStatement* tf;
     llvm::BasicBlock* landingPad;
+    // the finally body is emitted once into finallyBB; jumps leaving the
+    // try block store their 1-based index into 'continuations' in
+    // 'selector' and branch there, 0 means falling off the try block
+    llvm::BasicBlock* finallyBB;
+    llvm::Value* selector;
+    std::vector<llvm::BasicBlock*> continuations;
     void emitCode(IRState* p);
-    EnclosingTryFinally(TryFinallyStatement* _tf, llvm::BasicBlock* _pad) 
-    : tf(_tf), landingPad(_pad) {}
+    EnclosingTryFinally(TryFinallyStatement* _tf, llvm::BasicBlock* _pad, llvm::BasicBlock* _finallyBB)
+    : tf(_tf), landingPad(_pad), finallyBB(_finallyBB), selector(NULL) {}
 };
 struct EnclosingVolatile : EnclosingHandler
 {
@@ -133,6 +141,10 @@ void DtoOverloadedIntrinsicName(TemplateInstance* ti, TemplateDeclaration* td, s
 /// Returns true if the symbol should be defined in the current module, not just declared.
 bool mustDefineSymbol(Dsymbol* s);
 
+/// Returns true if s belongs to a template instance that another module
+/// of this multi-object build emits.
+bool isTemplateInstanceOwnedElsewhere(Dsymbol* s);
+
 /// Returns true if the symbol needs template linkage, or just external.
 bool needsTemplateLinkage(Dsymbol* s);
 
@@ -154,6 +166,10 @@ size_t realignOffset(size_t offset, Type* type);
 /// functions without problems.
 LLValue* makeLValue(Loc& loc, DValue* value);
 
+/// Returns an expression of the given type referring to the memory at addr,
+/// so values computed in codegen can be passed to DtoCallFunction.
+Expression* DtoLvalueExp(Loc& loc, Type* type, LLValue* addr);
+
 #if DMDV2
 void callPostblit(Loc &loc, Expression *exp, LLValue *val);
 #endif
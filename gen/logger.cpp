@@ -38,8 +38,11 @@ namespace Logger
 {
     static std::string indent_str;
 
-    llvm::cl::opt<bool> _enabled("vv",
+    bool _enabled = false;
+
+    static llvm::cl::opt<bool, true> enabledOpt("vv",
         llvm::cl::desc("Very verbose"),
+        llvm::cl::location(_enabled),
         llvm::cl::ZeroOrMore);
 
     void indent()
@@ -115,10 +118,6 @@ namespace Logger
     {
         _enabled = false;
     }
-    bool enabled()
-    {
-        return _enabled;
-    }
     void attention(Loc loc, const char* fmt,...)
     {
         va_list va;
@@ -80,6 +80,9 @@ private:
 
 namespace Logger
 {
+    // Backing storage of the -vv switch, use enabled() to query it.
+    extern bool _enabled;
+
     void indent();
     void undent();
     Stream cout();
@@ -87,7 +90,7 @@ namespace Logger
     void print(const char* fmt, ...) IS_PRINTF(1);
     void enable();
     void disable();
-    bool enabled();
+    inline bool enabled() { return _enabled; }
 
     void attention(Loc loc, const char* fmt, ...) IS_PRINTF(2);
 
@@ -106,7 +109,10 @@ namespace Logger
 
 #define LOG_SCOPE    Logger::LoggerScope _logscope;
 
-#define IF_LOG       if (Logger::enabled())
+// Guards a logging statement so that its arguments (toChars() calls and
+// the like) are only evaluated if -vv is in effect. Written so that it can
+// be safely used as the body of an unbraced if/else.
+#define IF_LOG       if (!Logger::enabled()) {} else
 
 #endif
 
@@ -207,7 +207,7 @@ llvm::Module* Module::genLLVMModule(llvm::LLVMContext& context, Ir* sir)
         Logger::enable();
     }
 
-    Logger::println("Generating module: %s\n", (md ? md->toChars() : toChars()));
+    IF_LOG Logger::println("Generating module: %s\n", (md ? md->toChars() : toChars()));
     LOG_SCOPE;
 
     if (global.params.verbose_cg)
@@ -267,8 +267,8 @@ llvm::Module* Module::genLLVMModule(llvm::LLVMContext& context, Ir* sir)
     // emit function bodies
     sir->emitFunctionBodies();
 
-    // for singleobj-compilation, fully emit all seen template instances
-    if (global.params.singleObj)
+    // if this module owns template instances, fully emit them
+    if (global.params.singleObj || global.params.templatesOnce)
     {
         while (!ir.seenTemplateInstances.empty())
         {
@@ -291,7 +291,7 @@ llvm::Module* Module::genLLVMModule(llvm::LLVMContext& context, Ir* sir)
     // verify the llvm
     if (!global.params.noVerify) {
         std::string verifyErr;
-        Logger::println("Verifying module...");
+        IF_LOG Logger::println("Verifying module...");
         LOG_SCOPE;
         if (llvm::verifyModule(*ir.module,llvm::ReturnStatusAction,&verifyErr))
         {
@@ -299,7 +299,7 @@ llvm::Module* Module::genLLVMModule(llvm::LLVMContext& context, Ir* sir)
             fatal();
         }
         else {
-            Logger::println("Verification passed!");
+            IF_LOG Logger::println("Verification passed!");
         }
     }
 
@@ -418,15 +418,15 @@ void Module::genmoduleinfo()
 
         if (cd->isInterfaceDeclaration())
         {
-            Logger::println("skipping interface '%s' in moduleinfo", cd->toPrettyChars());
+            IF_LOG Logger::println("skipping interface '%s' in moduleinfo", cd->toPrettyChars());
             continue;
         }
         else if (cd->sizeok != 1)
         {
-            Logger::println("skipping opaque class declaration '%s' in moduleinfo", cd->toPrettyChars());
+            IF_LOG Logger::println("skipping opaque class declaration '%s' in moduleinfo", cd->toPrettyChars());
             continue;
         }
-        Logger::println("class: %s", cd->toPrettyChars());
+        IF_LOG Logger::println("class: %s", cd->toPrettyChars());
         LLConstant *c = DtoBitCast(cd->ir.irStruct->getClassInfoSymbol(), getPtrToType(classinfoTy));
         classInits.push_back(c);
     }
@@ -636,7 +636,7 @@ void Module::genmoduleinfo()
     /*Logger::println("MODULE INFO INITIALIZERS");
     for (size_t i=0; i<initVec.size(); ++i)
     {
-        Logger::cout() << *initVec[i] << '\n';
+        IF_LOG Logger::cout() << *initVec[i] << '\n';
         if (initVec[i]->getType() != moduleinfoTy->getElementType(i))
             assert(0);
     }*/
@@ -25,7 +25,7 @@ void Statement::toNakedIR(IRState *p)
 
 void CompoundStatement::toNakedIR(IRState *p)
 {
-    Logger::println("CompoundStatement::toNakedIR(): %s", loc.toChars());
+    IF_LOG Logger::println("CompoundStatement::toNakedIR(): %s", loc.toChars());
     LOG_SCOPE;
 
     if (statements)
@@ -40,7 +40,7 @@ void CompoundStatement::toNakedIR(IRState *p)
 
 void ExpStatement::toNakedIR(IRState *p)
 {
-    Logger::println("ExpStatement::toNakedIR(): %s", loc.toChars());
+    IF_LOG Logger::println("ExpStatement::toNakedIR(): %s", loc.toChars());
     LOG_SCOPE;
 
     // only expstmt supported in declarations
@@ -82,7 +82,7 @@ void ExpStatement::toNakedIR(IRState *p)
 
 void LabelStatement::toNakedIR(IRState *p)
 {
-    Logger::println("LabelStatement::toNakedIR(): %s", loc.toChars());
+    IF_LOG Logger::println("LabelStatement::toNakedIR(): %s", loc.toChars());
     LOG_SCOPE;
 
     printLabelName(p->nakedAsm, p->func()->decl->mangle(), ident->toChars());
@@ -96,7 +96,7 @@ void LabelStatement::toNakedIR(IRState *p)
 
 void DtoDefineNakedFunction(FuncDeclaration* fd)
 {
-    Logger::println("DtoDefineNakedFunction(%s)", fd->mangle());
+    IF_LOG Logger::println("DtoDefineNakedFunction(%s)", fd->mangle());
     LOG_SCOPE;
 
     assert(fd->ir.irFunc);
@@ -196,7 +196,7 @@ void DtoDefineNakedFunction(FuncDeclaration* fd)
 
 void emitABIReturnAsmStmt(IRAsmBlock* asmblock, Loc loc, FuncDeclaration* fdecl)
 {
-    Logger::println("emitABIReturnAsmStmt(%s)", fdecl->mangle());
+    IF_LOG Logger::println("emitABIReturnAsmStmt(%s)", fdecl->mangle());
     LOG_SCOPE;
 
     IRAsmStmt* as = new IRAsmStmt;
@@ -353,7 +353,7 @@ void emitABIReturnAsmStmt(IRAsmBlock* asmblock, Loc loc, FuncDeclaration* fdecl)
 
 DValue * DtoInlineAsmExpr(Loc loc, FuncDeclaration * fd, Expressions * arguments)
 {
-    Logger::println("DtoInlineAsmExpr @ %s", loc.toChars());
+    IF_LOG Logger::println("DtoInlineAsmExpr @ %s", loc.toChars());
     LOG_SCOPE;
 
     TemplateInstance* ti = fd->toParent()->isTemplateInstance();
@@ -363,7 +363,7 @@ DValue * DtoInlineAsmExpr(Loc loc, FuncDeclaration * fd, Expressions * arguments
 
     // get code param
     Expression* e = (Expression*)arguments->data[0];
-    Logger::println("code exp: %s", e->toChars());
+    IF_LOG Logger::println("code exp: %s", e->toChars());
     StringExp* se = (StringExp*)e;
     if (e->op != TOKstring || se->sz != 1)
     {
@@ -374,7 +374,7 @@ DValue * DtoInlineAsmExpr(Loc loc, FuncDeclaration * fd, Expressions * arguments
 
     // get constraints param
     e = (Expression*)arguments->data[1];
-    Logger::println("constraint exp: %s", e->toChars());
+    IF_LOG Logger::println("constraint exp: %s", e->toChars());
     se = (StringExp*)e;
     if (e->op != TOKstring || se->sz != 1)
     {
@@ -92,7 +92,7 @@ static void DtoCreateNestedContextType(FuncDeclaration* fd);
 
 DValue* DtoNestedVariable(Loc loc, Type* astype, VarDeclaration* vd, bool byref)
 {
-    Logger::println("DtoNestedVariable for %s @ %s", vd->toChars(), loc.toChars());
+    IF_LOG Logger::println("DtoNestedVariable for %s @ %s", vd->toChars(), loc.toChars());
     LOG_SCOPE;
 
     ////////////////////////////////////
@@ -178,44 +178,44 @@ DValue* DtoNestedVariable(Loc loc, Type* astype, VarDeclaration* vd, bool byref)
     }
     else if (nestedCtx == NCHybrid) {
         LLValue* val = DtoBitCast(ctx, LLPointerType::getUnqual(irfunc->frameType));
-        Logger::cout() << "Context: " << *val << '\n';
-        Logger::cout() << "of type: " << *val->getType() << '\n';
+        IF_LOG Logger::cout() << "Context: " << *val << '\n';
+        IF_LOG Logger::cout() << "of type: " << *val->getType() << '\n';
 
         unsigned vardepth = vd->ir.irLocal->nestedDepth;
         unsigned funcdepth = irfunc->depth;
 
-        Logger::cout() << "Variable: " << vd->toChars() << '\n';
-        Logger::cout() << "Variable depth: " << vardepth << '\n';
-        Logger::cout() << "Function: " << irfunc->decl->toChars() << '\n';
-        Logger::cout() << "Function depth: " << funcdepth << '\n';
+        IF_LOG Logger::cout() << "Variable: " << vd->toChars() << '\n';
+        IF_LOG Logger::cout() << "Variable depth: " << vardepth << '\n';
+        IF_LOG Logger::cout() << "Function: " << irfunc->decl->toChars() << '\n';
+        IF_LOG Logger::cout() << "Function depth: " << funcdepth << '\n';
 
         if (vardepth == funcdepth) {
             // This is not always handled above because functions without
             // variables accessed by nested functions don't create new frames.
-            Logger::println("Same depth");
+            IF_LOG Logger::println("Same depth");
         } else {
             // Load frame pointer and index that...
             if (dwarfValue && global.params.symdebug) {
                 dwarfOpOffset(dwarfAddr, val, vd->ir.irLocal->nestedDepth);
                 dwarfOpDeref(dwarfAddr);
             }
-            Logger::println("Lower depth");
+            IF_LOG Logger::println("Lower depth");
             val = DtoGEPi(val, 0, vd->ir.irLocal->nestedDepth);
-            Logger::cout() << "Frame index: " << *val << '\n';
+            IF_LOG Logger::cout() << "Frame index: " << *val << '\n';
             val = DtoAlignedLoad(val, (std::string(".frame.") + vdparent->toChars()).c_str());
-            Logger::cout() << "Frame: " << *val << '\n';
+            IF_LOG Logger::cout() << "Frame: " << *val << '\n';
         }
 
         if (dwarfValue && global.params.symdebug)
             dwarfOpOffset(dwarfAddr, val, vd->ir.irLocal->nestedIndex);
         val = DtoGEPi(val, 0, vd->ir.irLocal->nestedIndex, vd->toChars());
-        Logger::cout() << "Addr: " << *val << '\n';
-        Logger::cout() << "of type: " << *val->getType() << '\n';
+        IF_LOG Logger::cout() << "Addr: " << *val << '\n';
+        IF_LOG Logger::cout() << "of type: " << *val->getType() << '\n';
         if (vd->ir.irLocal->byref || byref) {
             val = DtoAlignedLoad(val);
             //dwarfOpDeref(dwarfAddr);
-            Logger::cout() << "Was byref, now: " << *val << '\n';
-            Logger::cout() << "of type: " << *val->getType() << '\n';
+            IF_LOG Logger::cout() << "Was byref, now: " << *val << '\n';
+            IF_LOG Logger::cout() << "of type: " << *val->getType() << '\n';
         }
 
         if (dwarfValue && global.params.symdebug)
@@ -230,7 +230,7 @@ DValue* DtoNestedVariable(Loc loc, Type* astype, VarDeclaration* vd, bool byref)
 
 void DtoNestedInit(VarDeclaration* vd)
 {
-    Logger::println("DtoNestedInit for %s", vd->toChars());
+    IF_LOG Logger::println("DtoNestedInit for %s", vd->toChars());
     LOG_SCOPE
 
     IrFunction* irfunc = gIR->func()->decl->ir.irFunc;
@@ -284,7 +284,7 @@ void DtoResolveNestedContext(Loc loc, AggregateDeclaration *decl, LLValue *value
 void DtoResolveNestedContext(Loc loc, ClassDeclaration *decl, LLValue *value)
 #endif
 {
-    Logger::println("Resolving nested context");
+    IF_LOG Logger::println("Resolving nested context");
     LOG_SCOPE;
 
     // get context
@@ -300,7 +300,7 @@ void DtoResolveNestedContext(Loc loc, ClassDeclaration *decl, LLValue *value)
 
 LLValue* DtoNestedContext(Loc loc, Dsymbol* sym)
 {
-    Logger::println("DtoNestedContext for %s", sym->toPrettyChars());
+    IF_LOG Logger::println("DtoNestedContext for %s", sym->toPrettyChars());
     LOG_SCOPE;
 
     IrFunction* irfunc = gIR->func();
@@ -364,25 +364,25 @@ LLValue* DtoNestedContext(Loc loc, Dsymbol* sym)
             fd = getParentFunc(symfd, true);
         }
         if (fd) {
-            Logger::println("For nested function, parent is %s", fd->toChars());
+            IF_LOG Logger::println("For nested function, parent is %s", fd->toChars());
             FuncDeclaration* ctxfd = irfunc->decl;
-            Logger::println("Current function is %s", ctxfd->toChars());
+            IF_LOG Logger::println("Current function is %s", ctxfd->toChars());
             if (fromParent) {
                 ctxfd = getParentFunc(ctxfd, true);
                 assert(ctxfd && "Context from outer function, but no outer function?");
             }
-            Logger::println("Context is from %s", ctxfd->toChars());
+            IF_LOG Logger::println("Context is from %s", ctxfd->toChars());
 
             unsigned neededDepth = fd->ir.irFunc->depth;
             unsigned ctxDepth = ctxfd->ir.irFunc->depth;
 
-            Logger::cout() << "Needed depth: " << neededDepth << '\n';
-            Logger::cout() << "Context depth: " << ctxDepth << '\n';
+            IF_LOG Logger::cout() << "Needed depth: " << neededDepth << '\n';
+            IF_LOG Logger::cout() << "Context depth: " << ctxDepth << '\n';
 
             if (neededDepth >= ctxDepth) {
                 // assert(neededDepth <= ctxDepth + 1 && "How are we going more than one nesting level up?");
                 // fd needs the same context as we do, so all is well
-                Logger::println("Calling sibling function or directly nested function");
+                IF_LOG Logger::println("Calling sibling function or directly nested function");
             } else {
                 val = DtoBitCast(val, LLPointerType::getUnqual(ctxfd->ir.irFunc->frameType));
                 val = DtoGEPi(val, 0, neededDepth);
@@ -390,13 +390,13 @@ LLValue* DtoNestedContext(Loc loc, Dsymbol* sym)
             }
         }
     }
-    Logger::cout() << "result = " << *val << '\n';
-    Logger::cout() << "of type " << *val->getType() << '\n';
+    IF_LOG Logger::cout() << "result = " << *val << '\n';
+    IF_LOG Logger::cout() << "of type " << *val->getType() << '\n';
     return val;
 }
 
 static void DtoCreateNestedContextType(FuncDeclaration* fd) {
-    Logger::println("DtoCreateNestedContextType for %s", fd->toChars());
+    IF_LOG Logger::println("DtoCreateNestedContextType for %s", fd->toChars());
     LOG_SCOPE
 
     DtoDeclareFunction(fd);
@@ -421,7 +421,7 @@ static void DtoCreateNestedContextType(FuncDeclaration* fd) {
         // construct nested variables array
         if (!fd->nestedVars.empty())
         {
-            Logger::println("has nested frame");
+            IF_LOG Logger::println("has nested frame");
             // start with adding all enclosing parent frames until a static parent is reached
 
             LLStructType* innerFrameType = NULL;
@@ -438,7 +438,7 @@ static void DtoCreateNestedContextType(FuncDeclaration* fd) {
             }
             fd->ir.irFunc->depth = ++depth;
 
-            Logger::cout() << "Function " << fd->toChars() << " has depth " << depth << '\n';
+            IF_LOG Logger::cout() << "Function " << fd->toChars() << " has depth " << depth << '\n';
 
             typedef std::vector<LLType*> TypeVec;
             TypeVec types;
@@ -514,7 +514,7 @@ static void DtoCreateNestedContextType(FuncDeclaration* fd) {
             LLStructType* frameType = LLStructType::create(gIR->context(), types,
                                                            std::string("nest.") + fd->toChars());
 
-            Logger::cout() << "frameType = " << *frameType << '\n';
+            IF_LOG Logger::cout() << "frameType = " << *frameType << '\n';
 
             // Store type in IrFunction
             fd->ir.irFunc->frameType = frameType;
@@ -532,7 +532,7 @@ static void DtoCreateNestedContextType(FuncDeclaration* fd) {
 
 
 void DtoCreateNestedContext(FuncDeclaration* fd) {
-    Logger::println("DtoCreateNestedContext for %s", fd->toChars());
+    IF_LOG Logger::println("DtoCreateNestedContext for %s", fd->toChars());
     LOG_SCOPE
 
     DtoCreateNestedContextType(fd);
@@ -541,7 +541,7 @@ void DtoCreateNestedContext(FuncDeclaration* fd) {
         // construct nested variables array
         if (!fd->nestedVars.empty())
         {
-            Logger::println("has nested frame");
+            IF_LOG Logger::println("has nested frame");
             // start with adding all enclosing parent frames until a static parent is reached
             int nparelems = 0;
             if (!fd->isStatic())
@@ -612,14 +612,14 @@ void DtoCreateNestedContext(FuncDeclaration* fd) {
 
                 if (vd->isParameter())
                 {
-                    Logger::println("nested param: %s", vd->toChars());
+                    IF_LOG Logger::println("nested param: %s", vd->toChars());
                     LLValue* gep = DtoGEPi(nestedVars, 0, idx);
                     LLValue* val = DtoBitCast(vd->ir.irLocal->value, getVoidPtrType());
                     DtoAlignedStore(val, gep);
                 }
                 else
                 {
-                    Logger::println("nested var:   %s", vd->toChars());
+                    IF_LOG Logger::println("nested var:   %s", vd->toChars());
                 }
 
                 vd->ir.irLocal->nestedIndex = idx++;
@@ -658,7 +658,7 @@ void DtoCreateNestedContext(FuncDeclaration* fd) {
 #endif
                     assert(cd);
                     assert(cd->vthis);
-                    Logger::println("Indexing to 'this'");
+                    IF_LOG Logger::println("Indexing to 'this'");
 #if DMDV2
                     if (cd->isStructDeclaration())
                         src = DtoExtractValue(thisval, cd->vthis->ir.irField->index, ".vthis");
@@ -690,11 +690,11 @@ void DtoCreateNestedContext(FuncDeclaration* fd) {
 
                 LLValue* gep = DtoGEPi(frame, 0, vd->ir.irLocal->nestedIndex, vd->toChars());
                 if (vd->isParameter()) {
-                    Logger::println("nested param: %s", vd->toChars());
+                    IF_LOG Logger::println("nested param: %s", vd->toChars());
                     LOG_SCOPE
                     LLValue* value = vd->ir.irLocal->value;
                     if (llvm::isa<llvm::AllocaInst>(llvm::GetUnderlyingObject(value))) {
-                        Logger::println("Copying to nested frame");
+                        IF_LOG Logger::println("Copying to nested frame");
                         // The parameter value is an alloca'd stack slot.
                         // Copy to the nesting frame and leave the alloca for
                         // the optimizers to clean up.
@@ -703,7 +703,7 @@ void DtoCreateNestedContext(FuncDeclaration* fd) {
                         gep->takeName(value);
                         vd->ir.irLocal->value = gep;
                     } else {
-                        Logger::println("Adding pointer to nested frame");
+                        IF_LOG Logger::println("Adding pointer to nested frame");
                         // The parameter value is something else, such as a
                         // passed-in pointer (for 'ref' or 'out' parameters) or
                         // a pointer arg with byval attribute.
@@ -716,9 +716,9 @@ void DtoCreateNestedContext(FuncDeclaration* fd) {
                     // which move around in memory.
                     assert(vd->ir.irLocal->byref);
                 } else {
-                    Logger::println("nested var:   %s", vd->toChars());
+                    IF_LOG Logger::println("nested var:   %s", vd->toChars());
                     if (vd->ir.irLocal->value)
-                        Logger::cout() << "Pre-existing value: " << *vd->ir.irLocal->value << '\n';
+                        IF_LOG Logger::cout() << "Pre-existing value: " << *vd->ir.irLocal->value << '\n';
                     assert(!vd->ir.irLocal->value);
                     vd->ir.irLocal->value = gep;
                     assert(!vd->ir.irLocal->byref);
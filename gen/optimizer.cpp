@@ -11,10 +11,13 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/PassNameParser.h"
 #include "llvm/Transforms/IPO.h"
+#include "llvm/Transforms/IPO/PassManagerBuilder.h"
 
 #include "mars.h"       // error()
 #include "root.h"
 #include <cstring>      // strcmp();
+#include <string>
+#include <vector>
 
 using namespace llvm;
 
@@ -34,8 +37,8 @@ static cl::opt<unsigned char> optimizeLevel(
         clEnumValN(1, "O1", "Simple optimizations"),
         clEnumValN(2, "O2", "Good optimizations"),
         clEnumValN(3, "O3", "Aggressive optimizations"),
-        clEnumValN(4, "O4", "Link-time optimization"), //  not implemented?
-        clEnumValN(5, "O5", "Link-time optimization"), //  not implemented?
+        clEnumValN(4, "O4", "Link-time optimization"),
+        clEnumValN(5, "O5", "Link-time optimization"),
         clEnumValEnd),
     cl::init(0));
 
@@ -55,6 +58,11 @@ disableSimplifyRuntimeCalls("disable-simplify-drtcalls",
     cl::desc("Disable simplification of runtime calls in -O<N>"),
     cl::ZeroOrMore);
 
+static cl::opt<bool>
+disableBoundsCheckElim("disable-boundscheck-elim",
+    cl::desc("Disable elimination of redundant array bounds checks in -O<N>"),
+    cl::ZeroOrMore);
+
 static cl::opt<bool>
 disableGCToStack("disable-gc2stack",
     cl::desc("Disable promotion of GC allocations to stack memory in -O<N>"),
@@ -95,6 +103,10 @@ bool optimize() {
     return optimizeLevel || doInline() || !passList.empty();
 }
 
+bool doLTO() {
+    return optimizeLevel >= 4;
+}
+
 static void addPass(PassManager& pm, Pass* pass) {
     pm.add(pass);
 
@@ -160,10 +172,8 @@ static void addPassesForOptLevel(PassManager& pm) {
             if (!disableSimplifyRuntimeCalls)
                 addPass(pm, createSimplifyDRuntimeCalls());
 
-#if USE_METADATA
             if (!disableGCToStack)
                 addPass(pm, createGarbageCollect2Stack());
-#endif // USE_METADATA
         }
         // Run some clean-up passes
         addPass(pm, createInstructionCombiningPass());
@@ -190,6 +200,8 @@ static void addPassesForOptLevel(PassManager& pm) {
         addPass(pm, createLoopUnswitchPass());
         addPass(pm, createInstructionCombiningPass());
         addPass(pm, createIndVarSimplifyPass());
+        if (!disableLangSpecificPasses && !disableBoundsCheckElim)
+            addPass(pm, createEliminateBoundsChecks());
         addPass(pm, createLoopDeletionPass());
         addPass(pm, createLoopUnrollPass());
         addPass(pm, createInstructionCombiningPass());
@@ -211,13 +223,40 @@ static void addPassesForOptLevel(PassManager& pm) {
         addPass(pm, createGlobalDCEPass());
     }
 
-    // level -O4 and -O5 are linktime optimizations
+    // level -O4 and -O5 are linktime optimizations, see addLinkTimePasses
+}
+
+// Internalizes all D symbols of a whole program module except for _Dmain.
+// Everything else, like extern(C) functions, may still be referenced by
+// C code or the runtime and keeps its linkage.
+static void addInternalizePass(PassManager& pm, llvm::Module* m) {
+    std::vector<std::string> names;
+    for (llvm::Module::iterator I = m->begin(), E = m->end(); I != E; ++I)
+        if (!I->isDeclaration() && !I->getName().startswith("_D"))
+            names.push_back(I->getName());
+    for (llvm::Module::global_iterator I = m->global_begin(), E = m->global_end(); I != E; ++I)
+        if (!I->isDeclaration() && !I->getName().startswith("_D"))
+            names.push_back(I->getName());
+    names.push_back("_Dmain");
+
+    // the pass copies the names
+    std::vector<const char*> exportList;
+    for (size_t i = 0; i < names.size(); i++)
+        exportList.push_back(names[i].c_str());
+    addPass(pm, createInternalizePass(exportList));
+}
+
+// After internalization, the interprocedural passes can make use of seeing
+// all callers of most functions.
+static void addLinkTimePasses(PassManager& pm) {
+    PassManagerBuilder builder;
+    builder.populateLTOPassManager(pm, /*Internalize=*/false, doInline());
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // This function runs optimization passes based on command line arguments.
 // Returns true if any optimization passes were invoked.
-bool ldc_optimize_module(llvm::Module* m)
+bool ldc_optimize_module(llvm::Module* m, bool wholeProgram)
 {
     if (!optimize())
         return false;
@@ -228,6 +267,10 @@ bool ldc_optimize_module(llvm::Module* m)
 
     addPass(pm, new TargetData(m));
 
+    wholeProgram = wholeProgram && doLTO();
+    if (wholeProgram)
+        addInternalizePass(pm, m);
+
     bool optimize = optimizeLevel != 0 || doInline();
 
     unsigned optPos = optimizeLevel != 0
@@ -257,6 +300,9 @@ bool ldc_optimize_module(llvm::Module* m)
     if (optimize)
         addPassesForOptLevel(pm);
 
+    if (wholeProgram)
+        addLinkTimePasses(pm);
+
     pm.run(*m);
     return true;
 }
@@ -3,7 +3,9 @@
 
 namespace llvm { class Module; }
 
-bool ldc_optimize_module(llvm::Module* m);
+// With wholeProgram, all symbols not needed from outside of m are
+// internalized and the link-time optimization passes are run as well.
+bool ldc_optimize_module(llvm::Module* m, bool wholeProgram = false);
 
 // Determines whether the inliner will run in the -O<N> list of passes
 bool doInline();
@@ -12,6 +14,9 @@ bool willInline();
 
 int optLevel();
 
+// Determines whether link-time optimization was requested (-O4/-O5).
+bool doLTO();
+
 bool optimize();
 
 #endif
@@ -0,0 +1,129 @@
+//===- EliminateBoundsChecks - Remove provably redundant bounds checks ----===//
+//
+//                             The LLVM D Compiler
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements a pass that removes array bounds checks which can be
+// shown to always succeed, like the one for a[i] inside of
+// 'for (i = 0; i < a.length; i++)'.
+//
+// A bounds check as emitted by DtoArrayBoundsCheck() is a conditional branch
+// on an unsigned comparison, whose false edge leads to a block calling
+// _d_array_bounds. If scalar evolution can prove that the comparison is
+// always true, the branch is replaced by an unconditional one. The then
+// unreachable failure blocks are left to -simplifycfg.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "eliminate-boundschecks"
+
+#include "Passes.h"
+
+#include "llvm/Function.h"
+#include "llvm/Instructions.h"
+#include "llvm/Pass.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/CallSite.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+
+STATISTIC(NumChecks, "Number of array bounds checks found");
+STATISTIC(NumEliminated, "Number of array bounds checks eliminated");
+
+namespace {
+    /// This pass removes array bounds checks that are known to succeed.
+    class LLVM_LIBRARY_VISIBILITY EliminateBoundsChecks : public FunctionPass {
+        bool isBoundsCheckFailure(BasicBlock* BB);
+
+    public:
+        static char ID; // Pass identification
+        EliminateBoundsChecks() : FunctionPass(ID) {}
+
+        bool runOnFunction(Function &F);
+
+        virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+          // Removing the branches to the failure blocks changes the exits
+          // of loops, so the cached trip counts of ScalarEvolution go stale.
+          AU.addRequired<ScalarEvolution>();
+        }
+    };
+    char EliminateBoundsChecks::ID = 0;
+} // end anonymous namespace.
+
+static RegisterPass<EliminateBoundsChecks>
+X("eliminate-boundschecks", "Eliminate redundant array bounds checks");
+
+// Public interface to the pass.
+FunctionPass *createEliminateBoundsChecks() {
+  return new EliminateBoundsChecks();
+}
+
+/// isBoundsCheckFailure - Returns true if BB reports an array bounds error,
+/// i.e. it calls (or invokes) _d_array_bounds.
+bool EliminateBoundsChecks::isBoundsCheckFailure(BasicBlock* BB) {
+    for (BasicBlock::iterator I = BB->begin(), E = BB->end(); I != E; ++I) {
+        CallSite CS(I);
+        if (!CS.getInstruction())
+            continue;
+        Function* Callee = CS.getCalledFunction();
+        if (Callee && Callee->getName() == "_d_array_bounds")
+            return true;
+    }
+    return false;
+}
+
+/// runOnFunction - Top level algorithm.
+///
+bool EliminateBoundsChecks::runOnFunction(Function &F) {
+    ScalarEvolution& SE = getAnalysis<ScalarEvolution>();
+    bool Changed = false;
+
+    for (Function::iterator BB = F.begin(), E = F.end(); BB != E; ++BB) {
+        BranchInst* BI = dyn_cast<BranchInst>(BB->getTerminator());
+        if (!BI || !BI->isConditional())
+            continue;
+
+        // The checks branch to the failure block if the condition is false.
+        BasicBlock* OkBB = BI->getSuccessor(0);
+        BasicBlock* FailBB = BI->getSuccessor(1);
+        if (OkBB == FailBB || !isBoundsCheckFailure(FailBB))
+            continue;
+
+        ICmpInst* Cmp = dyn_cast<ICmpInst>(BI->getCondition());
+        if (!Cmp)
+            continue;
+        ICmpInst::Predicate Pred = Cmp->getPredicate();
+        if (Pred != ICmpInst::ICMP_ULT && Pred != ICmpInst::ICMP_ULE)
+            continue;
+        if (!SE.isSCEVable(Cmp->getOperand(0)->getType()))
+            continue;
+
+        ++NumChecks;
+
+        const SCEV* LHS = SE.getSCEV(Cmp->getOperand(0));
+        const SCEV* RHS = SE.getSCEV(Cmp->getOperand(1));
+        if (!SE.isKnownPredicate(Pred, LHS, RHS))
+            continue;
+
+        DEBUG(errs() << "Eliminating bounds check: " << *Cmp << '\n');
+
+        FailBB->removePredecessor(BB);
+        BranchInst::Create(OkBB, BI);
+        BI->eraseFromParent();
+        if (Cmp->use_empty())
+            Cmp->eraseFromParent();
+
+        ++NumEliminated;
+        Changed = true;
+    }
+
+    return Changed;
+}
@@ -1,5 +1,3 @@
-#if USE_METADATA
-
 //===- GarbageCollect2Stack - Optimize calls to the D garbage collector ---===//
 //
 //                             The LLVM D Compiler
@@ -12,6 +10,12 @@
 // This file attempts to turn allocations on the garbage-collected heap into
 // stack allocations.
 //
+// Allocations of classes with a destructor are only promoted if they happen
+// at most once per call; the destructor is then run through
+// _d_callfinalizer() before every return from the function. Like for GC
+// allocated objects, it is not guaranteed to run if an exception propagates
+// out of the function.
+//
 //===----------------------------------------------------------------------===//
 
 #include "gen/metadata.h"
@@ -39,11 +43,28 @@
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <algorithm>
+
 using namespace llvm;
 
 STATISTIC(NumGcToStack, "Number of calls promoted to constant-size allocas");
 STATISTIC(NumToDynSize, "Number of calls promoted to dynamically-sized allocas");
 STATISTIC(NumDeleted, "Number of GC calls deleted because the return value was unused");
+STATISTIC(NumClasses, "Number of class allocations promoted to allocas");
+STATISTIC(NumFinalized, "Number of promoted class allocations needing a finalizer call");
+STATISTIC(NumClosures, "Number of closure allocations promoted to allocas");
+
+static cl::opt<unsigned>
+SizeLimit("dgc2stack-size-limit", cl::init(1024), cl::Hidden,
+  cl::desc("Require allocs to be smaller than n bytes to be promoted, 0 to ignore."));
+
+// The GC aligns all its allocations to this. Code may rely on it, e.g. for
+// real or vector fields of closure frames, which are allocated untyped.
+static const unsigned GCAlignment = 16;
+
+static void setGCAlignment(AllocaInst* AI, const TargetData& TD) {
+    AI->setAlignment(std::max(GCAlignment, TD.getABITypeAlignment(AI->getAllocatedType())));
+}
 
 
 namespace {
@@ -53,7 +74,7 @@ namespace {
         CallGraph* CG;
         CallGraphNode* CGNode;
         
-        const Type* getTypeFor(Value* typeinfo) const;
+        Type* getTypeFor(Value* typeinfo) const;
     };
 }
 
@@ -61,15 +82,15 @@ namespace {
 // Helper functions
 //===----------------------------------------------------------------------===//
 
-void EmitMemSet(IRBuilder<>& B, Value* Dst, Value* Val, Value* Len,
+static void EmitMemSet(IRBuilder<>& B, Value* Dst, Value* Val, Value* Len,
                 const Analysis& A) {
     Dst = B.CreateBitCast(Dst, PointerType::getUnqual(B.getInt8Ty()));
     
     Module *M = B.GetInsertBlock()->getParent()->getParent();
-    const Type* intTy = Len->getType();
-    const Type *VoidPtrTy = PointerType::getUnqual(B.getInt8Ty());
-    const Type *Tys[2] ={VoidPtrTy, intTy};
-    Function *MemSet = Intrinsic::getDeclaration(M, Intrinsic::memset, Tys, 2);
+    Type* intTy = Len->getType();
+    Type *VoidPtrTy = PointerType::getUnqual(B.getInt8Ty());
+    Type *Tys[2] ={VoidPtrTy, intTy};
+    Function *MemSet = Intrinsic::getDeclaration(M, Intrinsic::memset, makeArrayRef(Tys, 2));
     Value *Align = ConstantInt::get(B.getInt32Ty(), 1);
     
     CallSite CS = B.CreateCall5(MemSet, Dst, Val, Len, Align, B.getFalse());
@@ -90,18 +111,25 @@ static void EmitMemZero(IRBuilder<>& B, Value* Dst, Value* Len,
 namespace {
     class FunctionInfo {
     protected:
-        const Type* Ty;
+        Type* Ty;
         
     public:
         unsigned TypeInfoArgNr;
         bool SafeToDelete;
         
+        // Set by analyze() if the allocated object must be finalized
+        // before it goes out of scope.
+        bool NeedsFinalizer;
+        
         // Analyze the current call, filling in some fields. Returns true if
         // this is an allocation we can stack-allocate.
         virtual bool analyze(CallSite CS, const Analysis& A) {
+            NeedsFinalizer = false;
             Value* TypeInfo = CS.getArgument(TypeInfoArgNr);
             Ty = A.getTypeFor(TypeInfo);
-            return (Ty != NULL);
+            if (!Ty)
+                return false;
+            return !SizeLimit || A.TD.getTypeAllocSize(Ty) < SizeLimit;
         }
         
         // Returns the alloca to replace this call.
@@ -110,11 +138,14 @@ namespace {
             NumGcToStack++;
             
             Instruction* Begin = CS.getCaller()->getEntryBlock().begin();
-            return new AllocaInst(Ty, ".nongc_mem", Begin); // FIXME: align?
+            AllocaInst* alloca = new AllocaInst(Ty, ".nongc_mem", Begin);
+            setGCAlignment(alloca, A.TD);
+            return alloca;
         }
         
         FunctionInfo(unsigned typeInfoArgNr, bool safeToDelete)
-        : TypeInfoArgNr(typeInfoArgNr), SafeToDelete(safeToDelete) {}
+        : TypeInfoArgNr(typeInfoArgNr), SafeToDelete(safeToDelete),
+          NeedsFinalizer(false) {}
     };
     
     class ArrayFI : public FunctionInfo {
@@ -135,7 +166,7 @@ namespace {
                 return false;
             
             arrSize = CS.getArgument(ArrSizeArgNr);
-            const IntegerType* SizeType =
+            IntegerType* SizeType =
                 dyn_cast<IntegerType>(arrSize->getType());
             if (!SizeType)
                 return false;
@@ -150,17 +181,25 @@ namespace {
                     return false;
             }
             // Extract the element type from the array type.
-            const StructType* ArrTy = dyn_cast<StructType>(Ty);
+            StructType* ArrTy = dyn_cast<StructType>(Ty);
             assert(ArrTy && "Dynamic array type not a struct?");
             assert(isa<IntegerType>(ArrTy->getElementType(0)));
-            const PointerType* PtrTy =
+            PointerType* PtrTy =
                 cast<PointerType>(ArrTy->getElementType(1));
             Ty = PtrTy->getElementType();
+
+            // Only small arrays of constant length are promoted, dynamically
+            // sized allocas could easily overflow the stack.
+            ConstantInt* Len = dyn_cast<ConstantInt>(arrSize);
+            if (!Len)
+                return false;
+            if (SizeLimit && Len->getValue().ugt(SizeLimit / std::max<uint64_t>(1, A.TD.getTypeAllocSize(Ty))))
+                return false;
             return true;
         }
         
         virtual AllocaInst* promote(CallSite CS, IRBuilder<>& B, const Analysis& A) {
-            IRBuilder<> Builder = B;
+            IRBuilder<> Builder(B.GetInsertBlock(), B.GetInsertPoint());
             // If the allocation is of constant size it's best to put it in the
             // entry block, so do so if we're not already there.
             // For dynamically-sized allocations it's best to avoid the overhead
@@ -177,7 +216,8 @@ namespace {
             
             // Convert array size to 32 bits if necessary
             Value* count = Builder.CreateIntCast(arrSize, Builder.getInt32Ty(), false);
-            AllocaInst* alloca = Builder.CreateAlloca(Ty, count, ".nongc_mem"); // FIXME: align?
+            AllocaInst* alloca = Builder.CreateAlloca(Ty, count, ".nongc_mem");
+            setGCAlignment(alloca, A.TD);
             
             if (Initialized) {
                 // For now, only zero-init is supported.
@@ -193,12 +233,43 @@ namespace {
         }
     };
     
+    // FunctionInfo for _d_allocmemory, used for closures
+    class UntypedMemoryFI : public FunctionInfo {
+        Value* SizeArg;
+    public:
+        virtual bool analyze(CallSite CS, const Analysis& A) {
+            // This call contains no TypeInfo parameter, so don't call the
+            // base class implementation here...
+            NeedsFinalizer = false;
+            if (CS.arg_size() != 1)
+                return false;
+            ConstantInt* Size = dyn_cast<ConstantInt>(CS.getArgument(0));
+            if (!Size)
+                return false;
+            if (SizeLimit && Size->getValue().uge(SizeLimit))
+                return false;
+            // Allocate pointer-sized slots, promote() aligns them like the GC.
+            Type* SlotTy = A.TD.getIntPtrType(A.M.getContext());
+            uint64_t SlotSize = A.TD.getTypeAllocSize(SlotTy);
+            Ty = ArrayType::get(SlotTy, (Size->getZExtValue() + SlotSize - 1) / SlotSize);
+            return true;
+        }
+        
+        virtual AllocaInst* promote(CallSite CS, IRBuilder<>& B, const Analysis& A) {
+            NumClosures++;
+            return FunctionInfo::promote(CS, B, A);
+        }
+        
+        UntypedMemoryFI() : FunctionInfo(~0u, true) {}
+    };
+    
     // FunctionInfo for _d_allocclass
     class AllocClassFI : public FunctionInfo {
         public:
         virtual bool analyze(CallSite CS, const Analysis& A) {
             // This call contains no TypeInfo parameter, so don't call the
             // base class implementation here...
+            NeedsFinalizer = false;
             if (CS.arg_size() != 1)
                 return false;
             Value* arg = CS.getArgument(0)->stripPointerCasts();
@@ -213,29 +284,32 @@ namespace {
             if (!meta)
                 return false;
 
-            MDNode* node = static_cast<MDNode*>(meta->getElement(0));
+            MDNode* node = meta->getOperand(0);
             if (!node || MD_GetNumElements(node) != CD_NumFields)
                 return false;
 
-            // Inserting destructor calls is not implemented yet, so classes
-            // with destructors are ignored for now.
-            Constant* hasDestructor = dyn_cast<Constant>(MD_GetElement(node, CD_Finalize));
+            // Classes with destructors need a finalizer call when the
+            // object goes out of scope, see runOnFunction().
+            ConstantInt* hasDestructor = dyn_cast<ConstantInt>(MD_GetElement(node, CD_Finalize));
             // We can't stack-allocate if the class has a custom deallocator
             // (Custom allocators don't get turned into this runtime call, so
             // those can be ignored)
-            Constant* hasCustomDelete = dyn_cast<Constant>(MD_GetElement(node, CD_CustomDelete));
+            ConstantInt* hasCustomDelete = dyn_cast<ConstantInt>(MD_GetElement(node, CD_CustomDelete));
             if (hasDestructor == NULL || hasCustomDelete == NULL)
                 return false;
             
-            if (ConstantExpr::getOr(hasDestructor, hasCustomDelete)
-                    != ConstantInt::getFalse(A.M.getContext()))
+            if (!hasCustomDelete->isZero())
                 return false;
+            NeedsFinalizer = !hasDestructor->isZero();
             
             Ty = MD_GetElement(node, CD_BodyType)->getType();
-            return true;
+            return !SizeLimit || A.TD.getTypeAllocSize(Ty) < SizeLimit;
         }
         
-        // The default promote() should be fine.
+        virtual AllocaInst* promote(CallSite CS, IRBuilder<>& B, const Analysis& A) {
+            NumClasses++;
+            return FunctionInfo::promote(CS, B, A);
+        }
         
         AllocClassFI() : FunctionInfo(~0u, true) {}
     };
@@ -254,6 +328,7 @@ namespace {
         Module* M;
         
         FunctionInfo AllocMemoryT;
+        UntypedMemoryFI AllocMemory;
         ArrayFI NewArrayVT;
         ArrayFI NewArrayT;
         AllocClassFI AllocClass;
@@ -289,12 +364,13 @@ FunctionPass *createGarbageCollect2Stack() {
 }
 
 GarbageCollect2Stack::GarbageCollect2Stack()
-: FunctionPass(&ID),
+: FunctionPass(ID),
   AllocMemoryT(0, true),
   NewArrayVT(0, true, false, 1),
   NewArrayT(0, true, true, 1)
 {
     KnownFunctions["_d_allocmemoryT"] = &AllocMemoryT;
+    KnownFunctions["_d_allocmemory"] = &AllocMemory;
     KnownFunctions["_d_newarrayvT"] = &NewArrayVT;
     KnownFunctions["_d_newarrayT"] = &NewArrayT;
     KnownFunctions[_d_allocclass] = &AllocClass;
@@ -319,6 +395,43 @@ static void RemoveCall(CallSite CS, const Analysis& A) {
 
 static bool isSafeToStackAllocate(Instruction* Alloc, DominatorTree& DT);
 
+/// Returns whether Alloc may be executed more than once per call, i.e.
+/// whether its block is part of a cycle.
+static bool mayBeExecutedRepeatedly(Instruction* Alloc) {
+    BasicBlock* AllocBlock = Alloc->getParent();
+    SmallVector<BasicBlock*, 16> Worklist;
+    SmallSet<BasicBlock*, 16> Visited;
+    Worklist.push_back(AllocBlock);
+    while (!Worklist.empty()) {
+        BasicBlock* B = Worklist.pop_back_val();
+        TerminatorInst* Term = B->getTerminator();
+        for (unsigned i = 0, e = Term->getNumSuccessors(); i != e; ++i) {
+            BasicBlock* Succ = Term->getSuccessor(i);
+            if (Succ == AllocBlock)
+                return true;
+            if (Visited.insert(Succ))
+                Worklist.push_back(Succ);
+        }
+    }
+    return false;
+}
+
+/// Collects the return instructions of F into Returns. Returns false if
+/// Alloc does not dominate all of them, so an object allocated there cannot
+/// be finalized on return.
+static bool getReturnsDominatedBy(Function& F, Instruction* Alloc, DominatorTree& DT,
+                                  SmallVectorImpl<ReturnInst*>& Returns) {
+    for (Function::iterator BB = F.begin(), E = F.end(); BB != E; ++BB) {
+        ReturnInst* Ret = dyn_cast<ReturnInst>(BB->getTerminator());
+        if (!Ret)
+            continue;
+        if (!DT.dominates(Alloc, Ret))
+            return false;
+        Returns.push_back(Ret);
+    }
+    return true;
+}
+
 /// runOnFunction - Top level algorithm.
 ///
 bool GarbageCollect2Stack::runOnFunction(Function &F) {
@@ -340,7 +453,7 @@ bool GarbageCollect2Stack::runOnFunction(Function &F) {
         for (BasicBlock::iterator I = BB->begin(), E = BB->end(); I != E; ) {
             // Ignore non-calls.
             Instruction* Inst = I++;
-            CallSite CS = CallSite::get(Inst);
+            CallSite CS(Inst);
             if (!CS.getInstruction())
                 continue;
             
@@ -372,6 +485,15 @@ bool GarbageCollect2Stack::runOnFunction(Function &F) {
             if (!info->analyze(CS, A) || !isSafeToStackAllocate(Inst, DT))
                 continue;
             
+            // Objects with destructors are finalized before returning, which
+            // requires the allocation to happen exactly once on every path
+            // to a return.
+            SmallVector<ReturnInst*, 4> Returns;
+            bool Finalize = info->NeedsFinalizer;
+            if (Finalize && (mayBeExecutedRepeatedly(Inst) ||
+                    !getReturnsDominatedBy(F, Inst, DT, Returns)))
+                continue;
+            
             // Let's alloca this!
             Changed = true;
             
@@ -386,6 +508,21 @@ bool GarbageCollect2Stack::runOnFunction(Function &F) {
                 newVal = Builder.CreateBitCast(newVal, Inst->getType());
             Inst->replaceAllUsesWith(newVal);
             
+            if (Finalize) {
+                NumFinalized++;
+                LLVMContext& Context = M->getContext();
+                Type* VoidPtrTy = PointerType::getUnqual(Type::getInt8Ty(Context));
+                Constant* Finalizer = M->getOrInsertFunction("_d_callfinalizer",
+                    Type::getVoidTy(Context), VoidPtrTy, NULL);
+                for (unsigned i = 0; i < Returns.size(); i++) {
+                    IRBuilder<> RetBuilder(Returns[i]);
+                    CallInst* Call = RetBuilder.CreateCall(Finalizer,
+                        RetBuilder.CreateBitCast(newVal, VoidPtrTy));
+                    if (CGNode && isa<Function>(Finalizer))
+                        CGNode->addCalledFunction(Call, CG->getOrInsertFunction(cast<Function>(Finalizer)));
+                }
+            }
+            
             RemoveCall(CS, A);
         }
     }
@@ -393,7 +530,7 @@ bool GarbageCollect2Stack::runOnFunction(Function &F) {
     return Changed;
 }
 
-const Type* Analysis::getTypeFor(Value* typeinfo) const {
+Type* Analysis::getTypeFor(Value* typeinfo) const {
     GlobalVariable* ti_global = dyn_cast<GlobalVariable>(typeinfo->stripPointerCasts());
     if (!ti_global)
         return NULL;
@@ -405,7 +542,7 @@ const Type* Analysis::getTypeFor(Value* typeinfo) const {
     if (!meta)
         return NULL;
 
-    MDNode* node = static_cast<MDNode*>(meta->getElement(0));
+    MDNode* node = meta->getOperand(0);
     if (!node)
         return NULL;
 
@@ -584,7 +721,7 @@ bool isSafeToStackAllocate(Instruction* Alloc, DominatorTree& DT) {
     switch (I->getOpcode()) {
     case Instruction::Call:
     case Instruction::Invoke: {
-      CallSite CS = CallSite::get(I);
+      CallSite CS(I);
       // Not captured if the callee is readonly, doesn't return a copy through
       // its return value and doesn't unwind (a readonly function can leak bits
       // by throwing an exception or not depending on the input value).
@@ -608,9 +745,6 @@ bool isSafeToStackAllocate(Instruction* Alloc, DominatorTree& DT) {
       // captured.
       break;
     }
-    case Instruction::Free:
-      // Freeing a pointer does not cause it to be captured.
-      break;
     case Instruction::Load:
       // Loading from a pointer does not cause it to be captured.
       break;
@@ -646,5 +780,3 @@ bool isSafeToStackAllocate(Instruction* Alloc, DominatorTree& DT) {
   // All uses examined - not captured or live across original allocation.
   return true;
 }
-
-#endif // USE_METADATA
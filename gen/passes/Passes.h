@@ -10,9 +10,11 @@ namespace llvm {
 // Performs simplifications on runtime calls.
 llvm::FunctionPass* createSimplifyDRuntimeCalls();
 
-#if USE_METADATA
+// Removes array bounds checks that are known to succeed.
+llvm::FunctionPass* createEliminateBoundsChecks();
+
+// Promotes GC allocations that do not escape to stack memory.
 llvm::FunctionPass* createGarbageCollect2Stack();
-#endif // USE_METADATA
 
 llvm::ModulePass* createStripExternalsPass();
 
@@ -38,7 +38,7 @@ static void LLVM_D_BuildRuntimeModule();
 
 bool LLVM_D_InitRuntime()
 {
-    Logger::println("*** Initializing D runtime declarations ***");
+    IF_LOG Logger::println("*** Initializing D runtime declarations ***");
     LOG_SCOPE;
 
     if (!M)
@@ -50,7 +50,7 @@ bool LLVM_D_InitRuntime()
 void LLVM_D_FreeRuntime()
 {
     if (M) {
-        Logger::println("*** Freeing D runtime declarations ***");
+        IF_LOG Logger::println("*** Freeing D runtime declarations ***");
         delete M;
         M = NULL;
     }
@@ -169,10 +169,10 @@ static LLType* rt_complex(LLType* type)
 
 static void LLVM_D_BuildRuntimeModule()
 {
-    Logger::println("building module");
+    IF_LOG Logger::println("building module");
     M = new llvm::Module("ldc internal runtime", gIR->context());
 
-    Logger::println("building basic types");
+    IF_LOG Logger::println("building basic types");
     LLType* voidTy = LLType::getVoidTy(gIR->context());
     LLType* boolTy = LLType::getInt1Ty(gIR->context());
     LLType* byteTy = LLType::getInt8Ty(gIR->context());
@@ -181,7 +181,7 @@ static void LLVM_D_BuildRuntimeModule()
     LLType* longTy = LLType::getInt64Ty(gIR->context());
     LLType* sizeTy = DtoSize_t();
 
-    Logger::println("building float types");
+    IF_LOG Logger::println("building float types");
     LLType* floatTy = LLType::getFloatTy(gIR->context());
     LLType* doubleTy = LLType::getDoubleTy(gIR->context());
     LLType* realTy;
@@ -194,7 +194,7 @@ static void LLVM_D_BuildRuntimeModule()
     LLType* cdoubleTy = rt_complex(doubleTy);
     LLType* crealTy = rt_complex(realTy);
 
-    Logger::println("building aggr types");
+    IF_LOG Logger::println("building aggr types");
     LLType* voidPtrTy = rt_ptr(byteTy);
     LLType* voidArrayTy = rt_array(byteTy);
     LLType* voidArrayPtrTy = getPtrToType(voidArrayTy);
@@ -202,15 +202,15 @@ static void LLVM_D_BuildRuntimeModule()
     LLType* wstringTy = DtoType(Type::twchar->arrayOf());
     LLType* dstringTy = DtoType(Type::tdchar->arrayOf());
 
-    Logger::println("building class types");
+    IF_LOG Logger::println("building class types");
     LLType* objectTy = DtoType(ClassDeclaration::object->type);
     LLType* classInfoTy = DtoType(ClassDeclaration::classinfo->type);
     LLType* typeInfoTy = DtoType(Type::typeinfo->type);
 
-    Logger::println("building aa type");
+    IF_LOG Logger::println("building aa type");
     LLType* aaTy = rt_ptr(LLStructType::get(gIR->context()));
 
-    Logger::println("building functions");
+    IF_LOG Logger::println("building functions");
 
     /////////////////////////////////////////////////////////////////////////////////////
     /////////////////////////////////////////////////////////////////////////////////////
@@ -3,6 +3,7 @@
 #include <stdio.h>
 #include <math.h>
 #include <fstream>
+#include <map>
 
 #include "gen/llvm.h"
 #include "llvm/InlineAsm.h"
@@ -33,7 +34,7 @@
 
 void CompoundStatement::toIR(IRState* p)
 {
-    Logger::println("CompoundStatement::toIR(): %s", loc.toChars());
+    IF_LOG Logger::println("CompoundStatement::toIR(): %s", loc.toChars());
     LOG_SCOPE;
 
     for (unsigned i=0; i<statements->dim; i++)
@@ -49,7 +50,7 @@ void CompoundStatement::toIR(IRState* p)
 
 void ReturnStatement::toIR(IRState* p)
 {
-    Logger::println("ReturnStatement::toIR(): %s", loc.toChars());
+    IF_LOG Logger::println("ReturnStatement::toIR(): %s", loc.toChars());
     LOG_SCOPE;
 
     // emit dwarf stop point
@@ -103,7 +104,11 @@ void ReturnStatement::toIR(IRState* p)
                 // call postblit if necessary
                 if (!p->func()->type->isref) {
                     dval = exp->toElemDtor(p);
-                    callPostblit(loc, exp, dval->getRVal());
+                    // the nrvo variable is moved out, its destructor isn't run
+                    // either (see DtorExpStatement)
+                    FuncDeclaration* fd = p->func()->decl;
+                    if (!(fd->nrvo_can && fd->nrvo_var))
+                        callPostblit(loc, exp, dval->getRVal());
                 } else {
                     Expression *ae = exp->addressOf(NULL);
                     dval = ae->toElemDtor(p);
@@ -132,7 +137,7 @@ void ReturnStatement::toIR(IRState* p)
 #endif
                  ) && isaPointer(v->getType()))
             {
-                Logger::println("Loading value for return");
+                IF_LOG Logger::println("Loading value for return");
                 v = DtoLoad(v);
             }
 
@@ -153,8 +158,16 @@ void ReturnStatement::toIR(IRState* p)
                     Logger::cout() << "return value after cast: " << *v << '\n';
             }
 
-            // emit scopes
+            // emit scopes, finally blocks are shared between several jumps so
+            // the return value has to live in memory until they have run
+            LLValue* retslot = 0;
+            if (!p->func()->gen->targetScopes.empty()) {
+                retslot = DtoRawAlloca(v->getType(), 0, "return.slot");
+                DtoStore(v, retslot);
+            }
             DtoEnclosingHandlers(loc, NULL);
+            if (retslot)
+                v = DtoLoad(retslot);
 
             DtoDwarfFuncEnd(p->func()->decl);
             llvm::ReturnInst::Create(gIR->context(), v, p->scopebb());
@@ -179,7 +192,7 @@ void ReturnStatement::toIR(IRState* p)
 
 void ExpStatement::toIR(IRState* p)
 {
-    Logger::println("ExpStatement::toIR(): %s", loc.toChars());
+    IF_LOG Logger::println("ExpStatement::toIR(): %s", loc.toChars());
     LOG_SCOPE;
 
     // emit dwarf stop point
@@ -231,7 +244,7 @@ void DtorExpStatement::toIR(IRState *irs)
 
 void IfStatement::toIR(IRState* p)
 {
-    Logger::println("IfStatement::toIR(): %s", loc.toChars());
+    IF_LOG Logger::println("IfStatement::toIR(): %s", loc.toChars());
     LOG_SCOPE;
 
     // start a dwarf lexical block
@@ -291,7 +304,7 @@ void IfStatement::toIR(IRState* p)
 
 void ScopeStatement::toIR(IRState* p)
 {
-    Logger::println("ScopeStatement::toIR(): %s", loc.toChars());
+    IF_LOG Logger::println("ScopeStatement::toIR(): %s", loc.toChars());
     LOG_SCOPE;
 
     /*llvm::BasicBlock* oldend = p->scopeend();
@@ -322,7 +335,7 @@ void ScopeStatement::toIR(IRState* p)
     }
 
     /*p->scope().end = oldend;
-    Logger::println("Erasing scope endbb");
+    IF_LOG Logger::println("Erasing scope endbb");
     endbb->eraseFromParent();*/
 }
 
@@ -330,7 +343,7 @@ void ScopeStatement::toIR(IRState* p)
 
 void WhileStatement::toIR(IRState* p)
 {
-    Logger::println("WhileStatement::toIR(): %s", loc.toChars());
+    IF_LOG Logger::println("WhileStatement::toIR(): %s", loc.toChars());
     LOG_SCOPE;
 
     // start a dwarf lexical block
@@ -381,7 +394,7 @@ void WhileStatement::toIR(IRState* p)
 
 void DoStatement::toIR(IRState* p)
 {
-    Logger::println("DoStatement::toIR(): %s", loc.toChars());
+    IF_LOG Logger::println("DoStatement::toIR(): %s", loc.toChars());
     LOG_SCOPE;
 
     // start a dwarf lexical block
@@ -429,7 +442,7 @@ void DoStatement::toIR(IRState* p)
 
 void ForStatement::toIR(IRState* p)
 {
-    Logger::println("ForStatement::toIR(): %s", loc.toChars());
+    IF_LOG Logger::println("ForStatement::toIR(): %s", loc.toChars());
     LOG_SCOPE;
 
     // start new dwarf lexical block
@@ -507,7 +520,7 @@ void ForStatement::toIR(IRState* p)
 
 void BreakStatement::toIR(IRState* p)
 {
-    Logger::println("BreakStatement::toIR(): %s", loc.toChars());
+    IF_LOG Logger::println("BreakStatement::toIR(): %s", loc.toChars());
     LOG_SCOPE;
 
     // don't emit two terminators in a row
@@ -519,7 +532,7 @@ void BreakStatement::toIR(IRState* p)
     DtoDwarfStopPoint(loc.linnum);
 
     if (ident != 0) {
-        Logger::println("ident = %s", ident->toChars());
+        IF_LOG Logger::println("ident = %s", ident->toChars());
 
         DtoEnclosingHandlers(loc, target);
 
@@ -567,14 +580,14 @@ void BreakStatement::toIR(IRState* p)
 
 void ContinueStatement::toIR(IRState* p)
 {
-    Logger::println("ContinueStatement::toIR(): %s", loc.toChars());
+    IF_LOG Logger::println("ContinueStatement::toIR(): %s", loc.toChars());
     LOG_SCOPE;
 
     // emit dwarf stop point
     DtoDwarfStopPoint(loc.linnum);
 
     if (ident != 0) {
-        Logger::println("ident = %s", ident->toChars());
+        IF_LOG Logger::println("ident = %s", ident->toChars());
 
         DtoEnclosingHandlers(loc, target);
 
@@ -622,7 +635,7 @@ void ContinueStatement::toIR(IRState* p)
 
 void OnScopeStatement::toIR(IRState* p)
 {
-    Logger::println("OnScopeStatement::toIR(): %s", loc.toChars());
+    IF_LOG Logger::println("OnScopeStatement::toIR(): %s", loc.toChars());
     LOG_SCOPE;
 
     assert(statement);
@@ -633,7 +646,7 @@ void OnScopeStatement::toIR(IRState* p)
 
 void TryFinallyStatement::toIR(IRState* p)
 {
-    Logger::println("TryFinallyStatement::toIR(): %s", loc.toChars());
+    IF_LOG Logger::println("TryFinallyStatement::toIR(): %s", loc.toChars());
     LOG_SCOPE;
 
     // emit dwarf stop point
@@ -677,7 +690,8 @@ void TryFinallyStatement::toIR(IRState* p)
     IRLandingPad& pad = gIR->func()->gen->landingPadInfo;
     pad.addFinally(finalbody);
     pad.push(landingpadbb);
-    gIR->func()->gen->targetScopes.push_back(IRTargetScope(this,new EnclosingTryFinally(this,gIR->func()->gen->landingPad),NULL,NULL));
+    EnclosingTryFinally* handler = new EnclosingTryFinally(this, gIR->func()->gen->landingPad, finallybb);
+    gIR->func()->gen->targetScopes.push_back(IRTargetScope(this,handler,NULL,NULL));
 
     //
     // do the try block
@@ -690,8 +704,12 @@ void TryFinallyStatement::toIR(IRState* p)
     DtoDwarfBlockEnd();
 
     // terminate try BB
-    if (!p->scopereturned())
+    if (!p->scopereturned()) {
+        // jumps out of the try block share the finally block, select endbb
+        if (handler->selector)
+            DtoStore(DtoConstUint(0), handler->selector);
         llvm::BranchInst::Create(finallybb, p->scopebb());
+    }
 
     pad.pop();
     gIR->func()->gen->targetScopes.pop_back();
@@ -707,7 +725,16 @@ void TryFinallyStatement::toIR(IRState* p)
     // terminate finally
     //TODO: isn't it an error to have a 'returned' finally block?
     if (!gIR->scopereturned()) {
-        llvm::BranchInst::Create(endbb, p->scopebb());
+        size_t n = handler->continuations.size();
+        if (n == 0) {
+            llvm::BranchInst::Create(endbb, p->scopebb());
+        } else {
+            // dispatch to wherever we came from
+            LLValue* sel = DtoLoad(handler->selector, "finally.dest");
+            llvm::SwitchInst* sw = llvm::SwitchInst::Create(sel, endbb, n, p->scopebb());
+            for (size_t i = 0; i < n; ++i)
+                sw->addCase(DtoConstUint(i + 1), handler->continuations[i]);
+        }
     }
 
     // rewrite the scope
@@ -718,7 +745,7 @@ void TryFinallyStatement::toIR(IRState* p)
 
 void TryCatchStatement::toIR(IRState* p)
 {
-    Logger::println("TryCatchStatement::toIR(): %s", loc.toChars());
+    IF_LOG Logger::println("TryCatchStatement::toIR(): %s", loc.toChars());
     LOG_SCOPE;
 
     // emit dwarf stop point
@@ -774,7 +801,7 @@ void TryCatchStatement::toIR(IRState* p)
 
 void ThrowStatement::toIR(IRState* p)
 {
-    Logger::println("ThrowStatement::toIR(): %s", loc.toChars());
+    IF_LOG Logger::println("ThrowStatement::toIR(): %s", loc.toChars());
     LOG_SCOPE;
 
     // emit dwarf stop point
@@ -840,8 +867,8 @@ static LLValue* call_string_switch_runtime(llvm::Value* table, Expression* e)
 
     if (Logger::enabled())
     {
-        Logger::cout() << *table->getType() << '\n';
-        Logger::cout() << *fn->getFunctionType()->getParamType(0) << '\n';
+        IF_LOG Logger::cout() << *table->getType() << '\n';
+        IF_LOG Logger::cout() << *fn->getFunctionType()->getParamType(0) << '\n';
     }
     assert(table->getType() == fn->getFunctionType()->getParamType(0));
 
@@ -854,9 +881,106 @@ static LLValue* call_string_switch_runtime(llvm::Value* table, Expression* e)
     return call.getInstruction();
 }
 
+// string switches with more cases than this call the binary search in the
+// runtime instead of being dispatched inline
+static const unsigned maxInlineStringSwitchCases = 128;
+
+// emits a chain of memcmp calls comparing the string at ptr, which is known
+// to have the length of all the given cases, against each of them
+static void emit_string_compares(IRState* p, LLValue* ptr, const std::vector<Case*>& group,
+    CaseStatements* cases, llvm::BasicBlock* defbb, llvm::BasicBlock* oldend)
+{
+    for (size_t i = 0; i < group.size(); ++i)
+    {
+        Case* c = group[i];
+        CaseStatement* cs = cases->tdata()[c->index];
+
+        // pointer to the case string data
+        unsigned ptrIdx = 1;
+        LLConstant* str = llvm::ConstantExpr::getExtractValue(c->str->toConstElem(p), ptrIdx);
+        LLValue* nbytes = DtoConstSize_t(c->str->len * c->str->sz);
+
+        LLValue* cmp = DtoMemCmp(ptr, str, nbytes);
+        cmp = p->ir->CreateICmpEQ(cmp, DtoConstInt(0), "tmp");
+        llvm::BasicBlock* nextbb = llvm::BasicBlock::Create(gIR->context(), "stringswitch.next", p->topfunc(), oldend);
+        llvm::BranchInst::Create(cs->bodyBB, nextbb, cmp, p->scopebb());
+        p->scope() = IRScope(nextbb, oldend);
+    }
+    llvm::BranchInst::Create(defbb, p->scopebb());
+}
+
+// dispatches a switch on a string without calling into the runtime:
+// first on the length, then on the first character and finally by
+// comparing the remaining candidates with memcmp
+static void emit_inline_string_switch(IRState* p, Expression* condition, Array& caseArray,
+    CaseStatements* cases, llvm::BasicBlock* defbb, llvm::BasicBlock* oldend)
+{
+    DValue* val = condition->toElemDtor(p);
+    LLValue* len = DtoArrayLen(val);
+    LLValue* ptr = DtoArrayPtr(val);
+
+    // group the cases by length
+    typedef std::map<size_t, std::vector<Case*> > LengthGroups;
+    LengthGroups byLength;
+    for (size_t i = 0; i < caseArray.dim; ++i)
+    {
+        Case* c = (Case*)caseArray.data[i];
+        byLength[c->str->len].push_back(c);
+    }
+
+    llvm::SwitchInst* lenSwitch = llvm::SwitchInst::Create(len, defbb, byLength.size(), p->scopebb());
+    for (LengthGroups::iterator it = byLength.begin(); it != byLength.end(); ++it)
+    {
+        size_t length = it->first;
+        std::vector<Case*>& group = it->second;
+
+        // the empty string can only match a single case
+        if (length == 0)
+        {
+            lenSwitch->addCase(DtoConstSize_t(0), cases->tdata()[group[0]->index]->bodyBB);
+            continue;
+        }
+
+        llvm::BasicBlock* lenbb = llvm::BasicBlock::Create(gIR->context(), "stringswitch.len", p->topfunc(), oldend);
+        lenSwitch->addCase(DtoConstSize_t(length), lenbb);
+        p->scope() = IRScope(lenbb, oldend);
+
+        if (group.size() == 1)
+        {
+            emit_string_compares(p, ptr, group, cases, defbb, oldend);
+            continue;
+        }
+
+        // more than one candidate, look at the first character
+        typedef std::map<unsigned, std::vector<Case*> > CharGroups;
+        CharGroups byChar;
+        for (size_t i = 0; i < group.size(); ++i)
+            byChar[group[i]->str->charAt(0)].push_back(group[i]);
+
+        LLValue* first = DtoLoad(ptr);
+        llvm::SwitchInst* charSwitch = llvm::SwitchInst::Create(first, defbb, byChar.size(), p->scopebb());
+        for (CharGroups::iterator cit = byChar.begin(); cit != byChar.end(); ++cit)
+        {
+            LLConstantInt* ch = LLConstantInt::get(llvm::cast<llvm::IntegerType>(first->getType()), cit->first, false);
+
+            // a single character is all there is to compare
+            if (length == 1)
+            {
+                charSwitch->addCase(ch, cases->tdata()[cit->second[0]->index]->bodyBB);
+                continue;
+            }
+
+            llvm::BasicBlock* charbb = llvm::BasicBlock::Create(gIR->context(), "stringswitch.char", p->topfunc(), oldend);
+            charSwitch->addCase(ch, charbb);
+            p->scope() = IRScope(charbb, oldend);
+            emit_string_compares(p, ptr, cit->second, cases, defbb, oldend);
+        }
+    }
+}
+
 void SwitchStatement::toIR(IRState* p)
 {
-    Logger::println("SwitchStatement::toIR(): %s", loc.toChars());
+    IF_LOG Logger::println("SwitchStatement::toIR(): %s", loc.toChars());
     LOG_SCOPE;
 
     // emit dwarf stop point
@@ -896,7 +1020,7 @@ void SwitchStatement::toIR(IRState* p)
     // default
     llvm::BasicBlock* defbb = 0;
     if (sdefault) {
-        Logger::println("has default");
+        IF_LOG Logger::println("has default");
         defbb = llvm::BasicBlock::Create(gIR->context(), "default", p->topfunc(), oldend);
         sdefault->bodyBB = defbb;
     }
@@ -919,9 +1043,10 @@ void SwitchStatement::toIR(IRState* p)
         // string switch?
         llvm::Value* switchTable = 0;
         Array caseArray;
+        bool inlineStringSwitch = false;
         if (!condition->type->isintegral())
         {
-            Logger::println("is string switch");
+            IF_LOG Logger::println("is string switch");
             // build array of the stringexpS
             caseArray.reserve(cases->dim);
             for (unsigned i=0; i<cases->dim; ++i)
@@ -933,6 +1058,12 @@ void SwitchStatement::toIR(IRState* p)
             }
             // first sort it
             caseArray.sort();
+
+            // small switches are dispatched inline
+            inlineStringSwitch = (caseArray.dim <= maxInlineStringSwitchCases);
+        }
+        if (!condition->type->isintegral() && !inlineStringSwitch)
+        {
             // iterate and add indices to cases
             std::vector<LLConstant*> inits(caseArray.dim);
             for (size_t i=0; i<caseArray.dim; ++i)
@@ -962,24 +1093,31 @@ void SwitchStatement::toIR(IRState* p)
             switchTable = llvm::ConstantStruct::get(sTy, sinits);
         }
 
-        // condition var
-        LLValue* condVal;
-        // integral switch
-        if (condition->type->isintegral()) {
-            DValue* cond = condition->toElemDtor(p);
-            condVal = cond->getRVal();
-        }
-        // string switch
-        else {
-            condVal = call_string_switch_runtime(switchTable, condition);
+        if (inlineStringSwitch)
+        {
+            emit_inline_string_switch(p, condition, caseArray, cases, defbb ? defbb : endbb, oldend);
         }
-
-        // create switch and add the cases
-        llvm::SwitchInst* si = llvm::SwitchInst::Create(condVal, defbb ? defbb : endbb, cases->dim, p->scopebb());
-        for (unsigned i=0; i<cases->dim; ++i)
+        else
         {
-            CaseStatement* cs = (CaseStatement*)cases->data[i];
-            si->addCase(isaConstantInt(cs->llvmIdx), cs->bodyBB);
+            // condition var
+            LLValue* condVal;
+            // integral switch
+            if (condition->type->isintegral()) {
+                DValue* cond = condition->toElemDtor(p);
+                condVal = cond->getRVal();
+            }
+            // string switch
+            else {
+                condVal = call_string_switch_runtime(switchTable, condition);
+            }
+
+            // create switch and add the cases
+            llvm::SwitchInst* si = llvm::SwitchInst::Create(condVal, defbb ? defbb : endbb, cases->dim, p->scopebb());
+            for (unsigned i=0; i<cases->dim; ++i)
+            {
+                CaseStatement* cs = (CaseStatement*)cases->data[i];
+                si->addCase(isaConstantInt(cs->llvmIdx), cs->bodyBB);
+            }
         }
     }
     else
@@ -1015,7 +1153,7 @@ void SwitchStatement::toIR(IRState* p)
 //////////////////////////////////////////////////////////////////////////////
 void CaseStatement::toIR(IRState* p)
 {
-    Logger::println("CaseStatement::toIR(): %s", loc.toChars());
+    IF_LOG Logger::println("CaseStatement::toIR(): %s", loc.toChars());
     LOG_SCOPE;
 
     llvm::BasicBlock* nbb = llvm::BasicBlock::Create(gIR->context(), "case", p->topfunc(), p->scopeend());
@@ -1045,7 +1183,7 @@ void CaseStatement::toIR(IRState* p)
 //////////////////////////////////////////////////////////////////////////////
 void DefaultStatement::toIR(IRState* p)
 {
-    Logger::println("DefaultStatement::toIR(): %s", loc.toChars());
+    IF_LOG Logger::println("DefaultStatement::toIR(): %s", loc.toChars());
     LOG_SCOPE;
 
     assert(bodyBB);
@@ -1073,7 +1211,7 @@ void DefaultStatement::toIR(IRState* p)
 
 void UnrolledLoopStatement::toIR(IRState* p)
 {
-    Logger::println("UnrolledLoopStatement::toIR(): %s", loc.toChars());
+    IF_LOG Logger::println("UnrolledLoopStatement::toIR(): %s", loc.toChars());
     LOG_SCOPE;
 
     // if no statements, there's nothing to do
@@ -1146,7 +1284,7 @@ void UnrolledLoopStatement::toIR(IRState* p)
 
 void ForeachStatement::toIR(IRState* p)
 {
-    Logger::println("ForeachStatement::toIR(): %s", loc.toChars());
+    IF_LOG Logger::println("ForeachStatement::toIR(): %s", loc.toChars());
     LOG_SCOPE;
 
     // start a dwarf lexical block
@@ -1160,7 +1298,7 @@ void ForeachStatement::toIR(IRState* p)
     //Argument* arg = (Argument*)arguments->data[0];
     //Logger::println("Argument is %s", arg->toChars());
 
-    Logger::println("aggr = %s", aggr->toChars());
+    IF_LOG Logger::println("aggr = %s", aggr->toChars());
 
     // key
     LLType* keytype = key ? DtoType(key->type) : DtoSize_t();
@@ -1172,7 +1310,7 @@ void ForeachStatement::toIR(IRState* p)
     LLValue* zerokey = LLConstantInt::get(keytype,0,false);
 
     // value
-    Logger::println("value = %s", value->toPrettyChars());
+    IF_LOG Logger::println("value = %s", value->toPrettyChars());
     LLValue* valvar = NULL;
     if (!value->isRef() && !value->isOut()) {
         // Create a local variable to serve as the value.
@@ -1278,7 +1416,7 @@ void ForeachStatement::toIR(IRState* p)
 
 void ForeachRangeStatement::toIR(IRState* p)
 {
-    Logger::println("ForeachRangeStatement::toIR(): %s", loc.toChars());
+    IF_LOG Logger::println("ForeachRangeStatement::toIR(): %s", loc.toChars());
     LOG_SCOPE;
 
     // start a dwarf lexical block
@@ -1384,7 +1522,7 @@ void ForeachRangeStatement::toIR(IRState* p)
 
 void LabelStatement::toIR(IRState* p)
 {
-    Logger::println("LabelStatement::toIR(): %s", loc.toChars());
+    IF_LOG Logger::println("LabelStatement::toIR(): %s", loc.toChars());
     LOG_SCOPE;
 
     // if it's an inline asm label, we don't create a basicblock, just emit it in the asm
@@ -1430,7 +1568,7 @@ void LabelStatement::toIR(IRState* p)
 
 void GotoStatement::toIR(IRState* p)
 {
-    Logger::println("GotoStatement::toIR(): %s", loc.toChars());
+    IF_LOG Logger::println("GotoStatement::toIR(): %s", loc.toChars());
     LOG_SCOPE;
 
     DtoDwarfStopPoint(loc.linnum);
@@ -1447,7 +1585,7 @@ void GotoStatement::toIR(IRState* p)
 
 void GotoDefaultStatement::toIR(IRState* p)
 {
-    Logger::println("GotoDefaultStatement::toIR(): %s", loc.toChars());
+    IF_LOG Logger::println("GotoDefaultStatement::toIR(): %s", loc.toChars());
     LOG_SCOPE;
 
     DtoDwarfStopPoint(loc.linnum);
@@ -1468,7 +1606,7 @@ void GotoDefaultStatement::toIR(IRState* p)
 
 void GotoCaseStatement::toIR(IRState* p)
 {
-    Logger::println("GotoCaseStatement::toIR(): %s", loc.toChars());
+    IF_LOG Logger::println("GotoCaseStatement::toIR(): %s", loc.toChars());
     LOG_SCOPE;
 
     DtoDwarfStopPoint(loc.linnum);
@@ -1492,7 +1630,7 @@ void GotoCaseStatement::toIR(IRState* p)
 
 void WithStatement::toIR(IRState* p)
 {
-    Logger::println("WithStatement::toIR(): %s", loc.toChars());
+    IF_LOG Logger::println("WithStatement::toIR(): %s", loc.toChars());
     LOG_SCOPE;
 
     DtoDwarfBlockStart(loc);
@@ -1523,7 +1661,7 @@ static LLConstant* generate_unique_critical_section()
 
 void SynchronizedStatement::toIR(IRState* p)
 {
-    Logger::println("SynchronizedStatement::toIR(): %s", loc.toChars());
+    IF_LOG Logger::println("SynchronizedStatement::toIR(): %s", loc.toChars());
     LOG_SCOPE;
 
     // emit dwarf stop point
@@ -1562,7 +1700,7 @@ void SynchronizedStatement::toIR(IRState* p)
 
 void VolatileStatement::toIR(IRState* p)
 {
-    Logger::println("VolatileStatement::toIR(): %s", loc.toChars());
+    IF_LOG Logger::println("VolatileStatement::toIR(): %s", loc.toChars());
     LOG_SCOPE;
 
     // emit dwarf stop point
@@ -1604,7 +1742,7 @@ void VolatileStatement::toIR(IRState* p)
 
 void SwitchErrorStatement::toIR(IRState* p)
 {
-    Logger::println("SwitchErrorStatement::toIR(): %s", loc.toChars());
+    IF_LOG Logger::println("SwitchErrorStatement::toIR(): %s", loc.toChars());
     LOG_SCOPE;
 
     llvm::Function* fn = LLVM_D_GetRuntimeFunction(gIR->module, "_d_switch_error");
@@ -32,7 +32,7 @@ void DtoResolveStruct(StructDeclaration* sd)
     sd->ir.resolved = true;
 
     // log what we're doing
-    Logger::println("Resolving struct type: %s (%s)", sd->toChars(), sd->loc.toChars());
+    IF_LOG Logger::println("Resolving struct type: %s (%s)", sd->toChars(), sd->loc.toChars());
     LOG_SCOPE;
 
     // make sure type exists
@@ -115,7 +115,7 @@ LLValue* DtoStructEquals(TOK op, DValue* lhs, DValue* rhs)
 
 LLValue* DtoIndexStruct(LLValue* src, StructDeclaration* sd, VarDeclaration* vd)
 {
-    Logger::println("indexing struct field %s:", vd->toPrettyChars());
+    IF_LOG Logger::println("indexing struct field %s:", vd->toPrettyChars());
     LOG_SCOPE;
 
     DtoResolveStruct(sd);
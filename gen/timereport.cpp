@@ -0,0 +1,406 @@
+// The time report (-time-report) shows how the wall clock time, the CPU time
+// and the memory of a compilation are distributed over the compilation phases
+// and the modules, which template instantiations and CTFE calls took the
+// longest, and how full the frontend's string tables got.
+
+#include "gen/timereport.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/TimeValue.h"
+
+#include "dsymbol.h"
+#include "lexer.h"
+#include "mtype.h"
+
+#if POSIX
+#include <sys/resource.h>
+#endif
+
+namespace cl = llvm::cl;
+
+enum TimeReportFormat
+{
+    NoTimeReport,
+    TimeReportTable,
+    TimeReportJSON
+};
+
+static cl::opt<TimeReportFormat> timeReport(
+    cl::desc("Compilation time report:"),
+    cl::ZeroOrMore,
+    cl::values(
+        clEnumValN(TimeReportTable, "time-report", "Print the time and memory used by each phase and module"),
+        clEnumValN(TimeReportJSON, "time-report-json", "Same as -time-report, but print it as JSON"),
+        clEnumValEnd),
+    cl::init(NoTimeReport));
+
+static cl::opt<unsigned> timeReportTop("time-report-top",
+    cl::desc("Number of the slowest template instantiations and CTFE calls to report"),
+    cl::value_desc("N"),
+    cl::init(10));
+
+struct PhaseTimes
+{
+    double wall, cpu;
+    size_t alloc;   // growth of the malloc heap
+    size_t peakRSS; // peak of the process at the end of the phase
+
+    PhaseTimes() : wall(0), cpu(0), alloc(0), peakRSS(0) {}
+
+    void add(double w, double c, size_t a, size_t p)
+    {
+        wall += w;
+        cpu += c;
+        alloc += a;
+        peakRSS = std::max(peakRSS, p);
+    }
+};
+
+typedef std::map<std::string, PhaseTimes> PhaseMap;
+
+struct ModuleTimes
+{
+    std::string name;
+    double wall;
+    PhaseMap phases;
+
+    ModuleTimes() : wall(0) {}
+
+    bool operator<(const ModuleTimes& other) const
+    {
+        return wall > other.wall;
+    }
+};
+
+struct SlowSymbol
+{
+    double wall;
+    std::string name;
+
+    bool operator<(const SlowSymbol& other) const
+    {
+        return wall > other.wall;
+    }
+};
+
+// phases in the order they were first run
+static std::vector<std::string> phaseOrder;
+static PhaseMap phaseTotals;
+static std::map<std::string, ModuleTimes> moduleTimes;
+// sorted by decreasing time, with at most timeReportTop entries
+static std::vector<SlowSymbol> slowest[2];
+
+bool timeReportEnabled()
+{
+    return timeReport != NoTimeReport;
+}
+
+static double seconds(const llvm::sys::TimeValue& t)
+{
+    return t.seconds() + t.microseconds() / 1000000.0;
+}
+
+double wallTime()
+{
+    return seconds(llvm::sys::TimeValue::now());
+}
+
+static double cpuTime()
+{
+    llvm::sys::TimeValue elapsed, user, sys;
+    llvm::sys::Process::GetTimeUsage(elapsed, user, sys);
+    return seconds(user) + seconds(sys);
+}
+
+size_t peakMemoryUsage()
+{
+#if POSIX
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#if __APPLE__
+    return usage.ru_maxrss;
+#else
+    return (size_t)usage.ru_maxrss * 1024;
+#endif
+#else
+    return 0;
+#endif
+}
+
+static void recordPhase(const char* phase, const char* module, double wall, double cpu, size_t alloc, size_t peakRSS)
+{
+    std::string name(phase);
+    PhaseMap::iterator it = phaseTotals.find(name);
+    if (it == phaseTotals.end())
+    {
+        phaseOrder.push_back(name);
+        it = phaseTotals.insert(std::make_pair(name, PhaseTimes())).first;
+    }
+    it->second.add(wall, cpu, alloc, peakRSS);
+
+    if (module)
+    {
+        ModuleTimes& mt = moduleTimes[module];
+        mt.name = module;
+        mt.wall += wall;
+        mt.phases[name].add(wall, cpu, alloc, peakRSS);
+    }
+}
+
+void addPhaseTime(const char* phase, const char* module, double wall, double cpu, size_t peakRSS)
+{
+    if (timeReportEnabled())
+        recordPhase(phase, module, wall, cpu, 0, peakRSS);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+PhaseTimer::PhaseTimer(const char* phase, const char* module)
+: phase(phase), module(module), moduleSym(0), active(timeReportEnabled())
+{
+    start();
+}
+
+PhaseTimer::PhaseTimer(const char* phase, Dsymbol* module)
+: phase(phase), module(0), moduleSym(module), active(timeReportEnabled())
+{
+    start();
+}
+
+void PhaseTimer::start()
+{
+    if (!active)
+        return;
+    startMem = llvm::sys::Process::GetMallocUsage();
+    startCpu = cpuTime();
+    startWall = wallTime();
+}
+
+PhaseTimer::~PhaseTimer()
+{
+    if (!active)
+        return;
+    double wall = wallTime() - startWall;
+    double cpu = cpuTime() - startCpu;
+    size_t mem = llvm::sys::Process::GetMallocUsage();
+    if (moduleSym)
+        module = moduleSym->toPrettyChars();
+    recordPhase(phase, module, wall, cpu, mem > startMem ? mem - startMem : 0, peakMemoryUsage());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+SymbolTimer::SymbolTimer(Kind kind, Dsymbol* s)
+: kind(kind), sym(timeReportEnabled() ? s : 0)
+{
+    if (sym)
+        startWall = wallTime();
+}
+
+SymbolTimer::~SymbolTimer()
+{
+    if (!sym)
+        return;
+    double wall = wallTime() - startWall;
+
+    std::vector<SlowSymbol>& list = slowest[kind];
+    if (list.size() >= timeReportTop && (list.empty() || wall <= list.back().wall))
+        return;
+
+    SlowSymbol s;
+    s.wall = wall;
+    s.name = sym->toPrettyChars();
+    list.insert(std::upper_bound(list.begin(), list.end(), s), s);
+    if (list.size() > timeReportTop)
+        list.pop_back();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+static double megabytes(size_t bytes)
+{
+    return bytes / (1024.0 * 1024.0);
+}
+
+struct NamedStringTable
+{
+    const char* name;
+    StringTable* table;
+};
+
+static const NamedStringTable stringTables[] = {
+    { "identifiers", &Lexer::stringtable },
+    { "types", &Type::stringtable },
+    { "type decos", &Type::deco_stringtable }
+};
+
+static const size_t numStringTables = sizeof(stringTables) / sizeof(stringTables[0]);
+
+static void printTable()
+{
+    fprintf(stderr, "Compilation time report:\n");
+    fprintf(stderr, "  %-16s %10s %10s %11s %14s\n", "phase", "wall (s)", "cpu (s)", "alloc (MB)", "peak rss (MB)");
+    PhaseTimes total;
+    for (size_t i = 0; i < phaseOrder.size(); i++)
+    {
+        const PhaseTimes& t = phaseTotals[phaseOrder[i]];
+        fprintf(stderr, "  %-16s %10.4f %10.4f %11.1f %14.1f\n", phaseOrder[i].c_str(),
+            t.wall, t.cpu, megabytes(t.alloc), megabytes(t.peakRSS));
+        total.add(t.wall, t.cpu, t.alloc, t.peakRSS);
+    }
+    fprintf(stderr, "  %-16s %10.4f %10.4f %11.1f %14.1f\n", "total",
+        total.wall, total.cpu, megabytes(total.alloc), megabytes(total.peakRSS));
+
+    // one column for each phase that was timed per module
+    std::vector<std::string> columns;
+    for (size_t i = 0; i < phaseOrder.size(); i++)
+    {
+        std::map<std::string, ModuleTimes>::iterator it;
+        for (it = moduleTimes.begin(); it != moduleTimes.end(); ++it)
+        {
+            if (it->second.phases.count(phaseOrder[i]))
+            {
+                columns.push_back(phaseOrder[i]);
+                break;
+            }
+        }
+    }
+
+    std::vector<ModuleTimes> modules;
+    std::map<std::string, ModuleTimes>::iterator it;
+    for (it = moduleTimes.begin(); it != moduleTimes.end(); ++it)
+        modules.push_back(it->second);
+    std::sort(modules.begin(), modules.end());
+
+    if (!modules.empty())
+    {
+        fprintf(stderr, "\nWall time by module (s):\n");
+        fprintf(stderr, "  %10s", "total");
+        for (size_t i = 0; i < columns.size(); i++)
+            fprintf(stderr, " %*s", (int)std::max(columns[i].size(), (size_t)10), columns[i].c_str());
+        fprintf(stderr, "  module\n");
+
+        for (size_t j = 0; j < modules.size(); j++)
+        {
+            fprintf(stderr, "  %10.4f", modules[j].wall);
+            for (size_t i = 0; i < columns.size(); i++)
+            {
+                PhaseMap::iterator pt = modules[j].phases.find(columns[i]);
+                double wall = pt == modules[j].phases.end() ? 0 : pt->second.wall;
+                fprintf(stderr, " %*.4f", (int)std::max(columns[i].size(), (size_t)10), wall);
+            }
+            fprintf(stderr, "  %s\n", modules[j].name.c_str());
+        }
+    }
+
+    const char* titles[2] = { "Slowest template instantiations", "Slowest CTFE calls" };
+    for (int k = 0; k < 2; k++)
+    {
+        if (slowest[k].empty())
+            continue;
+        fprintf(stderr, "\n%s (wall s):\n", titles[k]);
+        for (size_t i = 0; i < slowest[k].size(); i++)
+            fprintf(stderr, "  %10.4f  %s\n", slowest[k][i].wall, slowest[k][i].name.c_str());
+    }
+
+    fprintf(stderr, "\nString tables:\n");
+    fprintf(stderr, "  %-12s %10s %10s %8s %10s %8s\n", "table", "entries", "slots", "load", "probes", "resizes");
+    for (size_t i = 0; i < numStringTables; i++)
+    {
+        StringTable* t = stringTables[i].table;
+        fprintf(stderr, "  %-12s %10u %10u %8.3f %10.3f %8u\n", stringTables[i].name,
+            t->count, t->tabledim, t->loadFactor(), t->probesPerSearch(), t->resizes);
+    }
+}
+
+static void printJSONString(const std::string& str)
+{
+    fputc('"', stderr);
+    for (size_t i = 0; i < str.size(); i++)
+    {
+        unsigned char c = str[i];
+        if (c == '"' || c == '\\')
+            fprintf(stderr, "\\%c", c);
+        else if (c < 0x20)
+            fprintf(stderr, "\\u%04x", c);
+        else
+            fputc(c, stderr);
+    }
+    fputc('"', stderr);
+}
+
+static void printJSONTimes(const PhaseTimes& t)
+{
+    fprintf(stderr, "{\"wall\": %f, \"cpu\": %f, \"alloc\": %lu, \"peakRSS\": %lu}",
+        t.wall, t.cpu, (unsigned long)t.alloc, (unsigned long)t.peakRSS);
+}
+
+static void printJSON()
+{
+    fprintf(stderr, "{\n  \"phases\": [");
+    for (size_t i = 0; i < phaseOrder.size(); i++)
+    {
+        fprintf(stderr, "%s\n    {\"name\": ", i ? "," : "");
+        printJSONString(phaseOrder[i]);
+        fprintf(stderr, ", \"times\": ");
+        printJSONTimes(phaseTotals[phaseOrder[i]]);
+        fprintf(stderr, "}");
+    }
+
+    fprintf(stderr, "\n  ],\n  \"modules\": [");
+    std::map<std::string, ModuleTimes>::iterator it;
+    for (it = moduleTimes.begin(); it != moduleTimes.end(); ++it)
+    {
+        fprintf(stderr, "%s\n    {\"name\": ", it == moduleTimes.begin() ? "" : ",");
+        printJSONString(it->first);
+        fprintf(stderr, ", \"wall\": %f, \"phases\": {", it->second.wall);
+        for (PhaseMap::iterator pt = it->second.phases.begin(); pt != it->second.phases.end(); ++pt)
+        {
+            if (pt != it->second.phases.begin())
+                fprintf(stderr, ", ");
+            printJSONString(pt->first);
+            fprintf(stderr, ": ");
+            printJSONTimes(pt->second);
+        }
+        fprintf(stderr, "}}");
+    }
+
+    const char* keys[2] = { "templateInstances", "ctfeCalls" };
+    for (int k = 0; k < 2; k++)
+    {
+        fprintf(stderr, "\n  ],\n  \"%s\": [", keys[k]);
+        for (size_t i = 0; i < slowest[k].size(); i++)
+        {
+            fprintf(stderr, "%s\n    {\"name\": ", i ? "," : "");
+            printJSONString(slowest[k][i].name);
+            fprintf(stderr, ", \"wall\": %f}", slowest[k][i].wall);
+        }
+    }
+
+    fprintf(stderr, "\n  ],\n  \"stringTables\": [");
+    for (size_t i = 0; i < numStringTables; i++)
+    {
+        StringTable* t = stringTables[i].table;
+        fprintf(stderr, "%s\n    {\"name\": ", i ? "," : "");
+        printJSONString(stringTables[i].name);
+        fprintf(stderr, ", \"entries\": %u, \"slots\": %u, \"loadFactor\": %f, \"probesPerSearch\": %f, \"resizes\": %u}",
+            t->count, t->tabledim, t->loadFactor(), t->probesPerSearch(), t->resizes);
+    }
+    fprintf(stderr, "\n  ]\n}\n");
+}
+
+void printTimeReport()
+{
+    if (timeReport == TimeReportTable)
+        printTable();
+    else if (timeReport == TimeReportJSON)
+        printJSON();
+}
@@ -0,0 +1,64 @@
+#ifndef LDC_GEN_TIMEREPORT_H
+#define LDC_GEN_TIMEREPORT_H
+
+#include <cstddef>
+
+struct Dsymbol;
+
+// Returns true if -time-report was passed.
+bool timeReportEnabled();
+
+// Measures the time and memory spent between its construction and its
+// destruction, and adds them to the given compilation phase, both in total
+// and for module if it isn't null. Phase timers must not be nested.
+class PhaseTimer
+{
+public:
+    PhaseTimer(const char* phase, const char* module = 0);
+    // The name of module is only looked up at the end, as parsing changes it.
+    PhaseTimer(const char* phase, Dsymbol* module);
+    ~PhaseTimer();
+
+private:
+    void start();
+
+    const char* phase;
+    const char* module;
+    Dsymbol* moduleSym;
+    bool active;
+    double startWall, startCpu;
+    size_t startMem;
+};
+
+// Measures a template instantiation or a CTFE call, for the list of the
+// slowest ones. Does nothing if s is null. The times include the nested
+// instantiations and calls.
+class SymbolTimer
+{
+public:
+    enum Kind { TemplateInstantiation, CTFECall };
+
+    SymbolTimer(Kind kind, Dsymbol* s);
+    ~SymbolTimer();
+
+private:
+    Kind kind;
+    Dsymbol* sym;
+    double startWall;
+};
+
+// Adds times that were measured elsewhere, e.g. by a code generation job
+// running in another process.
+void addPhaseTime(const char* phase, const char* module, double wall, double cpu, size_t peakRSS);
+
+// Returns the peak resident set size of the compiler so far in bytes, or 0
+// if it is unknown.
+size_t peakMemoryUsage();
+
+// Returns the wall clock time in seconds.
+double wallTime();
+
+// Prints the report requested by -time-report to stderr.
+void printTimeReport();
+
+#endif
@@ -154,7 +154,7 @@ static LLValue *fixArgument(DValue *argval, TypeFunction* tf, LLType *callableAr
         ty == Tstruct)
 #endif
     {
-        Logger::println("Loading struct type for function argument");
+        IF_LOG Logger::println("Loading struct type for function argument");
         arg = DtoLoad(arg);
     }
 
@@ -164,9 +164,9 @@ static LLValue *fixArgument(DValue *argval, TypeFunction* tf, LLType *callableAr
     #if 1
         if (Logger::enabled())
         {
-            Logger::cout() << "arg:     " << *arg << '\n';
-            Logger::cout() << "of type: " << *arg->getType() << '\n';
-            Logger::cout() << "expects: " << *callableArgType << '\n';
+            IF_LOG Logger::cout() << "arg:     " << *arg << '\n';
+            IF_LOG Logger::cout() << "of type: " << *arg->getType() << '\n';
+            IF_LOG Logger::cout() << "expects: " << *callableArgType << '\n';
         }
     #endif
         if (isaStruct(arg))
@@ -185,14 +185,14 @@ void DtoBuildDVarArgList(std::vector<LLValue*>& args,
                          size_t argidx,
                          LLFunctionType* callableTy)
 {
-    Logger::println("doing d-style variadic arguments");
+    IF_LOG Logger::println("doing d-style variadic arguments");
     LOG_SCOPE
 
     std::vector<LLType*> vtypes;
 
     // number of non variadic args
     int begin = Parameter::dim(tf->parameters);
-    Logger::println("num non vararg params = %d", begin);
+    IF_LOG Logger::println("num non vararg params = %d", begin);
 
     // get n args in arguments list
     size_t n_arguments = arguments ? arguments->dim : 0;
@@ -484,7 +484,7 @@ DValue* DtoCallFunction(Loc& loc, Type* resulttype, DValue* fnval, Expressions*
     // or a C style vararg call
     else
     {
-        Logger::println("doing normal arguments");
+        IF_LOG Logger::println("doing normal arguments");
         if (Logger::enabled()) {
             Logger::println("Arguments so far: (%d)", (int)args.size());
             Logger::indent();
@@ -570,10 +570,10 @@ DValue* DtoCallFunction(Loc& loc, Type* resulttype, DValue* fnval, Expressions*
 #if 0
     if (Logger::enabled())
     {
-        Logger::println("%lu params passed", args.size());
+        IF_LOG Logger::println("%lu params passed", args.size());
         for (int i=0; i<args.size(); ++i) {
             assert(args[i]);
-            Logger::cout() << "arg["<<i<<"] = " << *args[i] << '\n';
+            IF_LOG Logger::cout() << "arg["<<i<<"] = " << *args[i] << '\n';
         }
     }
 #endif
@@ -588,11 +588,58 @@ DValue* DtoCallFunction(Loc& loc, Type* resulttype, DValue* fnval, Expressions*
         Logger::cout() << "Calling: " << *callable << '\n';
 #endif
 
+#if DMDV2
+    bool isNothrow = tf->isnothrow;
+#else
+    bool isNothrow = false;
+#endif
+
     // call the function
-    LLCallSite call = gIR->CreateCallOrInvoke(callable, args, varname);
+    LLCallSite calls[2];
+    unsigned ncalls = 1;
+    LLValue* retval;
+    LLValue* speculativeTarget = dfnval ? dfnval->speculativeTarget : 0;
+    if (!speculativeTarget)
+    {
+        calls[0] = gIR->CreateCallOrInvoke(callable, args, varname, isNothrow);
+        retval = calls[0].getInstruction();
+    }
+    else
+    {
+        // call the likely target directly if the vtbl slot holds it, so it
+        // can be inlined, and fall back to the indirect call otherwise
+        llvm::BasicBlock* oldend = gIR->scopeend();
+        llvm::BasicBlock* directbb = llvm::BasicBlock::Create(gIR->context(), "call.direct", gIR->topfunc(), oldend);
+        llvm::BasicBlock* indirectbb = llvm::BasicBlock::Create(gIR->context(), "call.indirect", gIR->topfunc(), oldend);
+        llvm::BasicBlock* mergebb = llvm::BasicBlock::Create(gIR->context(), "call.merge", gIR->topfunc(), oldend);
+
+        LLValue* cond = gIR->ir->CreateICmpEQ(callable, speculativeTarget, "tmp");
+        gIR->ir->CreateCondBr(cond, directbb, indirectbb);
+
+        gIR->scope() = IRScope(directbb, indirectbb);
+        calls[0] = gIR->CreateCallOrInvoke(speculativeTarget, args, varname, isNothrow);
+        llvm::BasicBlock* directend = gIR->scopebb();
+        gIR->ir->CreateBr(mergebb);
+
+        gIR->scope() = IRScope(indirectbb, mergebb);
+        calls[1] = gIR->CreateCallOrInvoke(callable, args, varname, isNothrow);
+        llvm::BasicBlock* indirectend = gIR->scopebb();
+        gIR->ir->CreateBr(mergebb);
+        ncalls = 2;
+
+        gIR->scope() = IRScope(mergebb, oldend);
+        retval = calls[0].getInstruction();
+        if (*varname)
+        {
+            llvm::PHINode* phi = gIR->ir->CreatePHI(callableTy->getReturnType(), 2, varname);
+            phi->addIncoming(calls[0].getInstruction(), directend);
+            phi->addIncoming(calls[1].getInstruction(), indirectend);
+            retval = phi;
+        }
+    }
 
     // get return value
-    LLValue* retllval = (retinptr) ? args[0] : call.getInstruction();
+    LLValue* retllval = (retinptr) ? args[0] : retval;
 
     // Ignore ABI for intrinsics
     if (tf->linkage != LINKintrinsic && !retinptr)
@@ -613,7 +660,7 @@ DValue* DtoCallFunction(Loc& loc, Type* resulttype, DValue* fnval, Expressions*
 #endif
         )
     {
-        Logger::println("Storing return value to stack slot");
+        IF_LOG Logger::println("Storing return value to stack slot");
         LLValue* mem = DtoRawAlloca(retllval->getType(), 0);
         DtoStore(retllval, mem);
         retllval = mem;
@@ -626,7 +673,7 @@ DValue* DtoCallFunction(Loc& loc, Type* resulttype, DValue* fnval, Expressions*
         Type* nextbase = stripModifiers(tf->nextOf()->toBasetype());
         if (!rbase->equals(nextbase))
         {
-            Logger::println("repainting return value from '%s' to '%s'", tf->nextOf()->toChars(), rbase->toChars());
+            IF_LOG Logger::println("repainting return value from '%s' to '%s'", tf->nextOf()->toChars(), rbase->toChars());
             switch(rbase->ty)
             {
             case Tarray:
@@ -661,19 +708,31 @@ DValue* DtoCallFunction(Loc& loc, Type* resulttype, DValue* fnval, Expressions*
         }
     }
 
+    // function attributes
+    if (unsigned fnattrs = DtoFunctionAttrs(tf))
+    {
+        Attr.Index = ~0U;
+        Attr.Attrs = fnattrs;
+        attrs.push_back(Attr);
+    }
+
     // set calling convention and parameter attributes
     llvm::AttrListPtr attrlist = llvm::AttrListPtr::get(attrs.begin(), attrs.end());
-    if (dfnval && dfnval->func)
+    for (unsigned i = 0; i < ncalls; i++)
     {
-        LLFunction* llfunc = llvm::dyn_cast<LLFunction>(dfnval->val);
-        if (llfunc && llfunc->isIntrinsic()) // override intrinsic attrs
-            attrlist = llvm::Intrinsic::getAttributes((llvm::Intrinsic::ID)llfunc->getIntrinsicID());
+        LLCallSite& call = calls[i];
+        if (dfnval && dfnval->func)
+        {
+            LLFunction* llfunc = llvm::dyn_cast<LLFunction>(dfnval->val);
+            if (llfunc && llfunc->isIntrinsic()) // override intrinsic attrs
+                attrlist = llvm::Intrinsic::getAttributes((llvm::Intrinsic::ID)llfunc->getIntrinsicID());
+            else
+                call.setCallingConv(callconv);
+        }
         else
             call.setCallingConv(callconv);
+        call.setAttributes(attrlist);
     }
-    else
-        call.setCallingConv(callconv);
-    call.setAttributes(attrlist);
 
     // if we are returning through a pointer arg
     // or if we are returning a reference
@@ -376,7 +376,7 @@ void DtoDwarfLocalVariable(LLValue* ll, VarDeclaration* vd, llvm::ArrayRef<LLVal
     if (!global.params.symdebug)
         return;
 
-    Logger::println("D to dwarf local variable");
+    IF_LOG Logger::println("D to dwarf local variable");
     LOG_SCOPE;
 
     if (gIR->func()->diSubprogram == vd->debugFunc) // ensure that the debug variable is created only once
@@ -430,7 +430,7 @@ void DtoDwarfCompileUnit(Module* m)
     if (!global.params.symdebug)
         return;
 
-    Logger::println("D to dwarf compile_unit");
+    IF_LOG Logger::println("D to dwarf compile_unit");
     LOG_SCOPE;
 
     // prepare srcpath
@@ -464,7 +464,7 @@ llvm::DISubprogram DtoDwarfSubProgram(FuncDeclaration* fd)
     if (!global.params.symdebug)
         return llvm::DISubprogram();
 
-    Logger::println("D to dwarf subprogram");
+    IF_LOG Logger::println("D to dwarf subprogram");
     LOG_SCOPE;
 
     llvm::DIFile file = DtoDwarfFile(fd->loc);
@@ -493,7 +493,7 @@ llvm::DISubprogram DtoDwarfSubProgramInternal(const char* prettyname, const char
     if (!global.params.symdebug)
         return llvm::DISubprogram();
 
-    Logger::println("D to dwarf subprogram");
+    IF_LOG Logger::println("D to dwarf subprogram");
     LOG_SCOPE;
 
     llvm::DIFile file(DtoDwarfFile(Loc(gIR->dmodule, 0)));
@@ -518,7 +518,7 @@ llvm::DIGlobalVariable DtoDwarfGlobalVariable(LLGlobalVariable* ll, VarDeclarati
     if (!global.params.symdebug)
         return llvm::DIGlobalVariable();
 
-    Logger::println("D to dwarf global_variable");
+    IF_LOG Logger::println("D to dwarf global_variable");
     LOG_SCOPE;
 
     // FIXME: duplicates ?
@@ -532,7 +532,7 @@ void DtoDwarfFuncStart(FuncDeclaration* fd)
     if (!global.params.symdebug)
         return;
 
-    Logger::println("D to dwarf funcstart");
+    IF_LOG Logger::println("D to dwarf funcstart");
     LOG_SCOPE;
 
     assert((llvm::MDNode*)fd->ir.irFunc->diSubprogram != 0);
@@ -546,7 +546,7 @@ void DtoDwarfFuncEnd(FuncDeclaration* fd)
     if (!global.params.symdebug)
         return;
 
-    Logger::println("D to dwarf funcend");
+    IF_LOG Logger::println("D to dwarf funcend");
     LOG_SCOPE;
 
     assert((llvm::MDNode*)fd->ir.irFunc->diSubprogram != 0);
@@ -559,7 +559,7 @@ void DtoDwarfBlockStart(Loc loc)
     if (!global.params.symdebug)
         return;
 
-    Logger::println("D to dwarf block start");
+    IF_LOG Logger::println("D to dwarf block start");
     LOG_SCOPE;
 
     llvm::DILexicalBlock block = gIR->dibuilder.createLexicalBlock(
@@ -579,7 +579,7 @@ void DtoDwarfBlockEnd()
     if (!global.params.symdebug)
         return;
 
-    Logger::println("D to dwarf block end");
+    IF_LOG Logger::println("D to dwarf block end");
     LOG_SCOPE;
 
     IrFunction *fn = gIR->func();
@@ -594,7 +594,7 @@ void DtoDwarfStopPoint(unsigned ln)
     if (!global.params.symdebug)
         return;
 
-    Logger::println("D to dwarf stoppoint at line %u", ln);
+    IF_LOG Logger::println("D to dwarf stoppoint at line %u", ln);
     LOG_SCOPE;
     llvm::DebugLoc loc = llvm::DebugLoc::get(ln, 0, getCurrentScope());
     gIR->ir->SetCurrentDebugLocation(loc);
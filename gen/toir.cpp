@@ -64,7 +64,7 @@ void Expression::cacheLvalue(IRState* irs)
 DValue *Expression::toElemDtor(IRState *irs)
 {
 #if DMDV2
-    Logger::println("Expression::toElemDtor(): %s", toChars());
+    IF_LOG Logger::println("Expression::toElemDtor(): %s", toChars());
     size_t starti = irs->varsInScope().size();
     DValue *val = toElem(irs);
     size_t endi = irs->varsInScope().size();
@@ -86,7 +86,7 @@ DValue *Expression::toElemDtor(IRState *irs)
 
 DValue* DeclarationExp::toElem(IRState* p)
 {
-    Logger::print("DeclarationExp::toElem: %s | T=%s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("DeclarationExp::toElem: %s | T=%s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     return DtoDeclarationExp(declaration);
@@ -96,14 +96,14 @@ DValue* DeclarationExp::toElem(IRState* p)
 
 void VarExp::cacheLvalue(IRState* p)
 {
-    Logger::println("Caching l-value of %s", toChars());
+    IF_LOG Logger::println("Caching l-value of %s", toChars());
     LOG_SCOPE;
     cachedLvalue = toElem(p)->getLVal();
 }
 
 DValue* VarExp::toElem(IRState* p)
 {
-    Logger::print("VarExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("VarExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     assert(var);
@@ -116,7 +116,7 @@ DValue* VarExp::toElem(IRState* p)
 
     if (VarDeclaration* vd = var->isVarDeclaration())
     {
-        Logger::println("VarDeclaration ' %s ' of type ' %s '", vd->toChars(), vd->type->toChars());
+        IF_LOG Logger::println("VarDeclaration ' %s ' of type ' %s '", vd->toChars(), vd->type->toChars());
 
 #if DMDV2
         /* The magic variable __ctfe is always false at runtime
@@ -136,21 +136,21 @@ DValue* VarExp::toElem(IRState* p)
         // _arguments
         if (vd->ident == Id::_arguments && p->func()->_arguments)
         {
-            Logger::println("Id::_arguments");
+            IF_LOG Logger::println("Id::_arguments");
             LLValue* v = p->func()->_arguments;
             return new DVarValue(type, vd, v);
         }
         // _argptr
         else if (vd->ident == Id::_argptr && p->func()->_argptr)
         {
-            Logger::println("Id::_argptr");
+            IF_LOG Logger::println("Id::_argptr");
             LLValue* v = p->func()->_argptr;
             return new DVarValue(type, vd, v);
         }
         // _dollar
         else if (vd->ident == Id::dollar)
         {
-            Logger::println("Id::dollar");
+            IF_LOG Logger::println("Id::dollar");
             LLValue* val = 0;
             if (vd->ir.isSet() && (val = vd->ir.getIrValue())) {
                 // It must be length of a range
@@ -163,14 +163,14 @@ DValue* VarExp::toElem(IRState* p)
         // classinfo
         else if (ClassInfoDeclaration* cid = vd->isClassInfoDeclaration())
         {
-            Logger::println("ClassInfoDeclaration: %s", cid->cd->toChars());
+            IF_LOG Logger::println("ClassInfoDeclaration: %s", cid->cd->toChars());
             cid->cd->codegen(Type::sir);;
             return new DVarValue(type, vd, cid->cd->ir.irStruct->getClassInfoSymbol());
         }
         // typeinfo
         else if (TypeInfoDeclaration* tid = vd->isTypeInfoDeclaration())
         {
-            Logger::println("TypeInfoDeclaration");
+            IF_LOG Logger::println("TypeInfoDeclaration");
             tid->codegen(Type::sir);
             assert(tid->ir.getIrValue());
             LLType* vartype = DtoType(type);
@@ -185,20 +185,20 @@ DValue* VarExp::toElem(IRState* p)
     #else
         else if (vd->nestedref) {
     #endif
-            Logger::println("nested variable");
+            IF_LOG Logger::println("nested variable");
             return DtoNestedVariable(loc, type, vd);
         }
         // function parameter
         else if (vd->isParameter()) {
-            Logger::println("function param");
-            Logger::println("type: %s", vd->type->toChars());
+            IF_LOG Logger::println("function param");
+            IF_LOG Logger::println("type: %s", vd->type->toChars());
             FuncDeclaration* fd = vd->toParent2()->isFuncDeclaration();
             if (fd && fd != p->func()->decl) {
-                Logger::println("nested parameter");
+                IF_LOG Logger::println("nested parameter");
                 return DtoNestedVariable(loc, type, vd);
             }
             else if (vd->storage_class & STClazy) {
-                Logger::println("lazy parameter");
+                IF_LOG Logger::println("lazy parameter");
                 assert(type->ty == Tdelegate);
                 return new DVarValue(type, vd->ir.getIrValue());
             }
@@ -211,7 +211,7 @@ DValue* VarExp::toElem(IRState* p)
             else assert(0);
         }
         else {
-            Logger::println("a normal variable");
+            IF_LOG Logger::println("a normal variable");
 
             // take care of forward references of global variables
             if (vd->isDataseg() || (vd->storage_class & STCextern))
@@ -237,7 +237,7 @@ DValue* VarExp::toElem(IRState* p)
     }
     else if (FuncDeclaration* fdecl = var->isFuncDeclaration())
     {
-        Logger::println("FuncDeclaration");
+        IF_LOG Logger::println("FuncDeclaration");
         LLValue* func = 0;
 #if DMDV2
         fdecl = fdecl->toAliasFunc();
@@ -256,7 +256,7 @@ DValue* VarExp::toElem(IRState* p)
     {
         // this seems to be the static initialiser for structs
         Type* sdecltype = sdecl->type->toBasetype();
-        Logger::print("Sym: type=%s\n", sdecltype->toChars());
+        IF_LOG Logger::print("Sym: type=%s\n", sdecltype->toChars());
         assert(sdecltype->ty == Tstruct);
         TypeStruct* ts = (TypeStruct*)sdecltype;
         assert(ts->sym);
@@ -278,14 +278,14 @@ DValue* VarExp::toElem(IRState* p)
 
 LLConstant* VarExp::toConstElem(IRState* p)
 {
-    Logger::print("VarExp::toConstElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("VarExp::toConstElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     if (StaticStructInitDeclaration* sdecl = var->isStaticStructInitDeclaration())
     {
         // this seems to be the static initialiser for structs
         Type* sdecltype = sdecl->type->toBasetype();
-        Logger::print("Sym: type=%s\n", sdecltype->toChars());
+        IF_LOG Logger::print("Sym: type=%s\n", sdecltype->toChars());
         assert(sdecltype->ty == Tstruct);
         TypeStruct* ts = (TypeStruct*)sdecltype;
         ts->sym->codegen(Type::sir);
@@ -326,7 +326,7 @@ LLConstant* VarExp::toConstElem(IRState* p)
 
 DValue* IntegerExp::toElem(IRState* p)
 {
-    Logger::print("IntegerExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("IntegerExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
     LLConstant* c = toConstElem(p);
     return new DConstValue(type, c);
@@ -336,11 +336,11 @@ DValue* IntegerExp::toElem(IRState* p)
 
 LLConstant* IntegerExp::toConstElem(IRState* p)
 {
-    Logger::print("IntegerExp::toConstElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("IntegerExp::toConstElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
     LLType* t = DtoType(type);
     if (isaPointer(t)) {
-        Logger::println("pointer");
+        IF_LOG Logger::println("pointer");
         LLConstant* i = LLConstantInt::get(DtoSize_t(),(uint64_t)value,false);
         return llvm::ConstantExpr::getIntToPtr(i, t);
     }
@@ -356,7 +356,7 @@ LLConstant* IntegerExp::toConstElem(IRState* p)
 
 DValue* RealExp::toElem(IRState* p)
 {
-    Logger::print("RealExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("RealExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
     LLConstant* c = toConstElem(p);
     return new DConstValue(type, c);
@@ -366,7 +366,7 @@ DValue* RealExp::toElem(IRState* p)
 
 LLConstant* RealExp::toConstElem(IRState* p)
 {
-    Logger::print("RealExp::toConstElem: %s @ %s | %La\n", toChars(), type->toChars(), value);
+    IF_LOG Logger::print("RealExp::toConstElem: %s @ %s | %La\n", toChars(), type->toChars(), value);
     LOG_SCOPE;
     Type* t = type->toBasetype();
     return DtoConstFP(t, value);
@@ -376,7 +376,7 @@ LLConstant* RealExp::toConstElem(IRState* p)
 
 DValue* NullExp::toElem(IRState* p)
 {
-    Logger::print("NullExp::toElem(type=%s): %s\n", type->toChars(),toChars());
+    IF_LOG Logger::print("NullExp::toElem(type=%s): %s\n", type->toChars(),toChars());
     LOG_SCOPE;
     LLConstant* c = toConstElem(p);
     return new DNullValue(type, c);
@@ -386,7 +386,7 @@ DValue* NullExp::toElem(IRState* p)
 
 LLConstant* NullExp::toConstElem(IRState* p)
 {
-    Logger::print("NullExp::toConstElem(type=%s): %s\n", type->toChars(),toChars());
+    IF_LOG Logger::print("NullExp::toConstElem(type=%s): %s\n", type->toChars(),toChars());
     LOG_SCOPE;
     LLType* t = DtoType(type);
     if (type->ty == Tarray) {
@@ -404,7 +404,7 @@ LLConstant* NullExp::toConstElem(IRState* p)
 
 DValue* ComplexExp::toElem(IRState* p)
 {
-    Logger::print("ComplexExp::toElem(): %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("ComplexExp::toElem(): %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
     LLConstant* c = toConstElem(p);
     LLValue* res;
@@ -432,7 +432,7 @@ DValue* ComplexExp::toElem(IRState* p)
 
 LLConstant* ComplexExp::toConstElem(IRState* p)
 {
-    Logger::print("ComplexExp::toConstElem(): %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("ComplexExp::toConstElem(): %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
     return DtoConstComplex(type, value.re, value.im);
 }
@@ -441,7 +441,7 @@ LLConstant* ComplexExp::toConstElem(IRState* p)
 
 DValue* StringExp::toElem(IRState* p)
 {
-    Logger::print("StringExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("StringExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     Type* dtype = type->toBasetype();
@@ -510,7 +510,7 @@ DValue* StringExp::toElem(IRState* p)
 
 LLConstant* StringExp::toConstElem(IRState* p)
 {
-    Logger::print("StringExp::toConstElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("StringExp::toConstElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     Type* t = type->toBasetype();
@@ -581,12 +581,12 @@ LLConstant* StringExp::toConstElem(IRState* p)
 
 DValue* AssignExp::toElem(IRState* p)
 {
-    Logger::print("AssignExp::toElem: %s | (%s)(%s = %s)\n", toChars(), type->toChars(), e1->type->toChars(), e2->type ? e2->type->toChars() : 0);
+    IF_LOG Logger::print("AssignExp::toElem: %s | (%s)(%s = %s)\n", toChars(), type->toChars(), e1->type->toChars(), e2->type ? e2->type->toChars() : 0);
     LOG_SCOPE;
 
     if (e1->op == TOKarraylength)
     {
-        Logger::println("performing array.length assignment");
+        IF_LOG Logger::println("performing array.length assignment");
         ArrayLengthExp *ale = (ArrayLengthExp *)e1;
         DValue* arr = ale->e1->toElem(p);
         DVarValue arrval(ale->e1->type, arr->getLVal());
@@ -596,7 +596,7 @@ DValue* AssignExp::toElem(IRState* p)
         return newlen;
     }
 
-    Logger::println("performing normal assignment");
+    IF_LOG Logger::println("performing normal assignment");
 
     DValue* l = e1->toElem(p);
     DValue* r = e2->toElem(p);
@@ -628,7 +628,7 @@ static Expression* findLvalue(IRState* irs, Expression* exp)
 #define BIN_ASSIGN(X) \
 DValue* X##AssignExp::toElem(IRState* p) \
 { \
-    Logger::print(#X"AssignExp::toElem: %s @ %s\n", toChars(), type->toChars()); \
+    IF_LOG Logger::print(#X"AssignExp::toElem: %s @ %s\n", toChars(), type->toChars()); \
     LOG_SCOPE; \
     X##Exp e3(loc, e1, e2); \
     e3.type = e1->type; \
@@ -697,7 +697,7 @@ LLConstant* AddExp::toConstElem(IRState* p)
 
 DValue* AddExp::toElem(IRState* p)
 {
-    Logger::print("AddExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("AddExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     DValue* l = e1->toElem(p);
@@ -710,10 +710,10 @@ DValue* AddExp::toElem(IRState* p)
     errorOnIllegalArrayOp(this, e1, e2);
 
     if (e1type != e2type && e1type->ty == Tpointer) {
-        Logger::println("add to pointer");
+        IF_LOG Logger::println("add to pointer");
         if (DConstValue* cv = r->isConst()) {
             if (cv->c->isNullValue()) {
-                Logger::println("is zero");
+                IF_LOG Logger::println("is zero");
                 return new DImValue(type, l->getRVal());
             }
         }
@@ -749,7 +749,7 @@ LLConstant* MinExp::toConstElem(IRState* p)
 
 DValue* MinExp::toElem(IRState* p)
 {
-    Logger::print("MinExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("MinExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     DValue* l = e1->toElem(p);
@@ -790,7 +790,7 @@ DValue* MinExp::toElem(IRState* p)
 
 DValue* MulExp::toElem(IRState* p)
 {
-    Logger::print("MulExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("MulExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     DValue* l = e1->toElem(p);
@@ -809,7 +809,7 @@ DValue* MulExp::toElem(IRState* p)
 
 DValue* DivExp::toElem(IRState* p)
 {
-    Logger::print("DivExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("DivExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     DValue* l = e1->toElem(p);
@@ -828,7 +828,7 @@ DValue* DivExp::toElem(IRState* p)
 
 DValue* ModExp::toElem(IRState* p)
 {
-    Logger::print("ModExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("ModExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     DValue* l = e1->toElem(p);
@@ -847,7 +847,7 @@ DValue* ModExp::toElem(IRState* p)
 
 void CallExp::cacheLvalue(IRState* p)
 {
-    Logger::println("Caching l-value of %s", toChars());
+    IF_LOG Logger::println("Caching l-value of %s", toChars());
     LOG_SCOPE;
     cachedLvalue = toElem(p)->getLVal();
 }
@@ -856,7 +856,7 @@ void CallExp::cacheLvalue(IRState* p)
 
 DValue* CallExp::toElem(IRState* p)
 {
-    Logger::print("CallExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("CallExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     if (cachedLvalue)
@@ -889,6 +889,15 @@ DValue* CallExp::toElem(IRState* p)
     {
         FuncDeclaration* fndecl = dfnval->func;
 
+        // foreach over a narrow string with dchar decoding
+        if (DValue* result = DtoForeachUtf(loc, dfnval, arguments))
+            return result;
+#if DMDV2
+        // foreach over an associative array
+        if (DValue* result = DtoForeachAA(loc, dfnval, arguments))
+            return result;
+#endif
+
         // as requested by bearophile, see if it's a C printf call and that it's valid.
         if (global.params.warnings && checkPrintf)
         {
@@ -1113,7 +1122,7 @@ DValue* CallExp::toElem(IRState* p)
 
 DValue* CastExp::toElem(IRState* p)
 {
-    Logger::print("CastExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("CastExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     // get the value to cast
@@ -1136,7 +1145,7 @@ DValue* CastExp::toElem(IRState* p)
 
 LLConstant* CastExp::toConstElem(IRState* p)
 {
-    Logger::print("CastExp::toConstElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("CastExp::toConstElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     LLConstant* res;
@@ -1193,7 +1202,7 @@ Lerr:
 
 DValue* SymOffExp::toElem(IRState* p)
 {
-    Logger::print("SymOffExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("SymOffExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     assert(0 && "SymOffExp::toElem should no longer be called :/");
@@ -1204,15 +1213,15 @@ DValue* SymOffExp::toElem(IRState* p)
 
 DValue* AddrExp::toElem(IRState* p)
 {
-    Logger::println("AddrExp::toElem: %s @ %s", toChars(), type->toChars());
+    IF_LOG Logger::println("AddrExp::toElem: %s @ %s", toChars(), type->toChars());
     LOG_SCOPE;
     DValue* v = e1->toElem(p);
     if (v->isField()) {
-        Logger::println("is field");
+        IF_LOG Logger::println("is field");
         return v;
     }
     else if (DFuncValue* fv = v->isFunc()) {
-        Logger::println("is func");
+        IF_LOG Logger::println("is func");
         //Logger::println("FuncDeclaration");
         FuncDeclaration* fd = fv->func;
         assert(fd);
@@ -1220,10 +1229,10 @@ DValue* AddrExp::toElem(IRState* p)
         return new DFuncValue(fd, fd->ir.irFunc->func);
     }
     else if (v->isIm()) {
-        Logger::println("is immediate");
+        IF_LOG Logger::println("is immediate");
         return v;
     }
-    Logger::println("is nothing special");
+    IF_LOG Logger::println("is nothing special");
 
     // we special case here, since apparently taking the address of a slice is ok
     LLValue* lval;
@@ -1330,14 +1339,14 @@ LLConstant* AddrExp::toConstElem(IRState* p)
 
 void PtrExp::cacheLvalue(IRState* p)
 {
-    Logger::println("Caching l-value of %s", toChars());
+    IF_LOG Logger::println("Caching l-value of %s", toChars());
     LOG_SCOPE;
     cachedLvalue = e1->toElem(p)->getRVal();
 }
 
 DValue* PtrExp::toElem(IRState* p)
 {
-    Logger::println("PtrExp::toElem: %s @ %s", toChars(), type->toChars());
+    IF_LOG Logger::println("PtrExp::toElem: %s @ %s", toChars(), type->toChars());
     LOG_SCOPE;
 
     // function pointers are special
@@ -1364,19 +1373,19 @@ DValue* PtrExp::toElem(IRState* p)
 
 void DotVarExp::cacheLvalue(IRState* p)
 {
-    Logger::println("Caching l-value of %s", toChars());
+    IF_LOG Logger::println("Caching l-value of %s", toChars());
     LOG_SCOPE;
     cachedLvalue = toElem(p)->getLVal();
 }
 
 DValue* DotVarExp::toElem(IRState* p)
 {
-    Logger::print("DotVarExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("DotVarExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     if (cachedLvalue)
     {
-        Logger::println("using cached lvalue");
+        IF_LOG Logger::println("using cached lvalue");
         LLValue *V = cachedLvalue;
         VarDeclaration* vd = var->isVarDeclaration();
         assert(vd);
@@ -1445,20 +1454,69 @@ DValue* DotVarExp::toElem(IRState* p)
                 break;
         }
 
+        //
+        // try to find the function a virtual call ends up in
+        //
+        FuncDeclaration* target = NULL;
+        bool exactTarget = false;
+        if (vtbllookup && e1type->ty == Tclass &&
+            !((TypeClass*)e1type)->sym->isInterfaceDeclaration() &&
+            !fdecl->toParent()->isInterfaceDeclaration())
+        {
+            ClassDeclaration* cd = ((TypeClass*)e1type)->sym;
+            // a freshly allocated object has exactly the type it was created with
+            Expression* ex = e1;
+            while (ex->op == TOKcast)
+                ex = ((CastExp*)ex)->e1;
+            if (ex->op == TOKnew) {
+                Type* t = ((NewExp*)ex)->newtype->toBasetype();
+                if (t->ty == Tclass) {
+                    ClassDeclaration* newcd = ((TypeClass*)t)->sym;
+                    if (newcd == cd || cd->isBaseOf(newcd, NULL)) {
+                        cd = newcd;
+                        exactTarget = true;
+                    }
+                }
+            }
+            // final classes have no subclasses
+            if (cd->storage_class & STCfinal)
+                exactTarget = true;
+
+            target = DtoVirtualFunctionTarget(cd, fdecl);
+            // otherwise only guess if no other implementation is known
+            if (target && !exactTarget && (!optimize() || DtoHasKnownOverride(target)))
+                target = NULL;
+        }
+
         //
         // look up function
         //
+        LLValue* speculativeTarget = 0;
         if (!vtbllookup) {
             fdecl->codegen(Type::sir);
             funcval = fdecl->ir.irFunc->func;
             assert(funcval);
         }
+        else if (target && exactTarget) {
+            IF_LOG Logger::println("devirtualized call to: %s", target->toPrettyChars());
+            DtoResolveDsymbol(target);
+            target->codegen(Type::sir);
+            funcval = DtoBitCast(target->ir.irFunc->func, getPtrToType(DtoType(fdecl->type)));
+        }
         else {
             DImValue vthis3(e1type, vthis);
             funcval = DtoVirtualFunctionPointer(&vthis3, fdecl, toChars());
+            if (target) {
+                IF_LOG Logger::println("speculative call to: %s", target->toPrettyChars());
+                DtoResolveDsymbol(target);
+                target->codegen(Type::sir);
+                speculativeTarget = DtoBitCast(target->ir.irFunc->func, funcval->getType());
+            }
         }
 
-        return new DFuncValue(fdecl, funcval, vthis2);
+        DFuncValue* dfv = new DFuncValue(fdecl, funcval, vthis2);
+        dfv->speculativeTarget = speculativeTarget;
+        return dfv;
     }
     else {
         printf("unsupported dotvarexp: %s\n", var->toChars());
@@ -1472,7 +1530,7 @@ DValue* DotVarExp::toElem(IRState* p)
 
 DValue* ThisExp::toElem(IRState* p)
 {
-    Logger::print("ThisExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("ThisExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     // regular this expr
@@ -1481,11 +1539,11 @@ DValue* ThisExp::toElem(IRState* p)
         Dsymbol* vdparent = vd->toParent2();
         Identifier *ident = p->func()->decl->ident;
         if (ident == Id::ensure || ident == Id::require) {
-            Logger::println("contract this exp");
+            IF_LOG Logger::println("contract this exp");
             v = p->func()->nestArg;
             v = DtoBitCast(v, DtoType(type)->getPointerTo());
         } else if (vdparent != p->func()->decl) {
-            Logger::println("nested this exp");
+            IF_LOG Logger::println("nested this exp");
 #if STRUCTTHISREF
             return DtoNestedVariable(loc, type, vd, type->ty == Tstruct);
 #else
@@ -1493,7 +1551,7 @@ DValue* ThisExp::toElem(IRState* p)
 #endif
         }
         else {
-            Logger::println("normal this exp");
+            IF_LOG Logger::println("normal this exp");
             v = p->func()->thisArg;
         }
         return new DVarValue(type, vd, v);
@@ -1508,14 +1566,14 @@ DValue* ThisExp::toElem(IRState* p)
 
 void IndexExp::cacheLvalue(IRState* p)
 {
-    Logger::println("Caching l-value of %s", toChars());
+    IF_LOG Logger::println("Caching l-value of %s", toChars());
     LOG_SCOPE;
     cachedLvalue = toElem(p)->getLVal();
 }
 
 DValue* IndexExp::toElem(IRState* p)
 {
-    Logger::print("IndexExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("IndexExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     if (cachedLvalue)
@@ -1553,7 +1611,7 @@ DValue* IndexExp::toElem(IRState* p)
         return DtoAAIndex(loc, type, l, r, modifiable);
     }
     else {
-        Logger::println("invalid index exp! e1type: %s", e1type->toChars());
+        IF_LOG Logger::println("invalid index exp! e1type: %s", e1type->toChars());
         assert(0);
     }
     return new DVarValue(type, arrptr);
@@ -1563,7 +1621,7 @@ DValue* IndexExp::toElem(IRState* p)
 
 DValue* SliceExp::toElem(IRState* p)
 {
-    Logger::print("SliceExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("SliceExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     // this is the new slicing code, it's different in that a full slice will no longer retain the original pointer.
@@ -1644,7 +1702,7 @@ DValue* SliceExp::toElem(IRState* p)
 
 DValue* CmpExp::toElem(IRState* p)
 {
-    Logger::print("CmpExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("CmpExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     DValue* l = e1->toElem(p);
@@ -1702,8 +1760,8 @@ DValue* CmpExp::toElem(IRState* p)
             LLValue* b = r->getRVal();
             if (Logger::enabled())
             {
-                Logger::cout() << "type 1: " << *a << '\n';
-                Logger::cout() << "type 2: " << *b << '\n';
+                IF_LOG Logger::cout() << "type 1: " << *a << '\n';
+                IF_LOG Logger::cout() << "type 2: " << *b << '\n';
             }
             if (a->getType() != b->getType())
                 b = DtoBitCast(b, a->getType());
@@ -1747,7 +1805,7 @@ DValue* CmpExp::toElem(IRState* p)
     }
     else if (t->ty == Tsarray || t->ty == Tarray)
     {
-        Logger::println("static or dynamic array");
+        IF_LOG Logger::println("static or dynamic array");
         eval = DtoArrayCompare(loc,op,l,r);
     }
     else if (t->ty == Taarray)
@@ -1766,7 +1824,7 @@ DValue* CmpExp::toElem(IRState* p)
 
 DValue* EqualExp::toElem(IRState* p)
 {
-    Logger::print("EqualExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("EqualExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     DValue* l = e1->toElem(p);
@@ -1782,7 +1840,7 @@ DValue* EqualExp::toElem(IRState* p)
     // class equality should be rewritten as a.opEquals(b) by this time
     if (t->isintegral() || t->ty == Tpointer || t->ty == Tclass || t->ty == Tnull)
     {
-        Logger::println("integral or pointer or interface");
+        IF_LOG Logger::println("integral or pointer or interface");
         llvm::ICmpInst::Predicate cmpop;
         switch(op)
         {
@@ -1800,8 +1858,8 @@ DValue* EqualExp::toElem(IRState* p)
         }
         if (Logger::enabled())
         {
-            Logger::cout() << "lv: " << *lv << '\n';
-            Logger::cout() << "rv: " << *rv << '\n';
+            IF_LOG Logger::cout() << "lv: " << *lv << '\n';
+            IF_LOG Logger::cout() << "rv: " << *rv << '\n';
         }
         eval = p->ir->CreateICmp(cmpop, lv, rv, "tmp");
     }
@@ -1811,22 +1869,22 @@ DValue* EqualExp::toElem(IRState* p)
     }
     else if (t->ty == Tsarray || t->ty == Tarray)
     {
-        Logger::println("static or dynamic array");
+        IF_LOG Logger::println("static or dynamic array");
         eval = DtoArrayEquals(loc,op,l,r);
     }
     else if (t->ty == Taarray)
     {
-        Logger::println("associative array");
+        IF_LOG Logger::println("associative array");
         eval = DtoAAEquals(loc,op,l,r);
     }
     else if (t->ty == Tdelegate)
     {
-        Logger::println("delegate");
+        IF_LOG Logger::println("delegate");
         eval = DtoDelegateEquals(op,l->getRVal(),r->getRVal());
     }
     else if (t->ty == Tstruct)
     {
-        Logger::println("struct");
+        IF_LOG Logger::println("struct");
         // when this is reached it means there is no opEquals overload.
         eval = DtoStructEquals(op,l,r);
     }
@@ -1842,7 +1900,7 @@ DValue* EqualExp::toElem(IRState* p)
 
 DValue* PostExp::toElem(IRState* p)
 {
-    Logger::print("PostExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("PostExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     DValue* l = e1->toElem(p);
@@ -1896,7 +1954,7 @@ DValue* PostExp::toElem(IRState* p)
 
 DValue* NewExp::toElem(IRState* p)
 {
-    Logger::print("NewExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("NewExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     assert(newtype);
@@ -1904,13 +1962,13 @@ DValue* NewExp::toElem(IRState* p)
 
     // new class
     if (ntype->ty == Tclass) {
-        Logger::println("new class");
+        IF_LOG Logger::println("new class");
         return DtoNewClass(loc, (TypeClass*)ntype, this);
     }
     // new dynamic array
     else if (ntype->ty == Tarray)
     {
-        Logger::println("new dynamic array: %s", newtype->toChars());
+        IF_LOG Logger::println("new dynamic array: %s", newtype->toChars());
         // get dim
         assert(arguments);
         assert(arguments->dim >= 1);
@@ -1937,7 +1995,7 @@ DValue* NewExp::toElem(IRState* p)
     // new struct
     else if (ntype->ty == Tstruct)
     {
-        Logger::println("new struct on heap: %s\n", newtype->toChars());
+        IF_LOG Logger::println("new struct on heap: %s\n", newtype->toChars());
         // allocate
         LLValue* mem = 0;
 #if DMDV2
@@ -1971,7 +2029,7 @@ DValue* NewExp::toElem(IRState* p)
         // call constructor
         if (member)
         {
-            Logger::println("Calling constructor");
+            IF_LOG Logger::println("Calling constructor");
             assert(arguments != NULL);
             member->codegen(Type::sir);
             DFuncValue dfn(member, member->ir.irFunc->func, mem);
@@ -2004,7 +2062,7 @@ DValue* NewExp::toElem(IRState* p)
 
 DValue* DeleteExp::toElem(IRState* p)
 {
-    Logger::print("DeleteExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("DeleteExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     DValue* dval = e1->toElem(p);
@@ -2073,7 +2131,7 @@ DValue* DeleteExp::toElem(IRState* p)
 
 DValue* ArrayLengthExp::toElem(IRState* p)
 {
-    Logger::print("ArrayLengthExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("ArrayLengthExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     DValue* u = e1->toElem(p);
@@ -2084,7 +2142,7 @@ DValue* ArrayLengthExp::toElem(IRState* p)
 
 DValue* AssertExp::toElem(IRState* p)
 {
-    Logger::print("AssertExp::toElem: %s\n", toChars());
+    IF_LOG Logger::print("AssertExp::toElem: %s\n", toChars());
     LOG_SCOPE;
 
     if(!global.params.useAssert)
@@ -2135,7 +2193,7 @@ DValue* AssertExp::toElem(IRState* p)
         condty->ty == Tclass &&
         !((TypeClass*)condty)->sym->isInterfaceDeclaration())
     {
-        Logger::println("calling class invariant");
+        IF_LOG Logger::println("calling class invariant");
         llvm::Function* fn = LLVM_D_GetRuntimeFunction(gIR->module, "_d_invariant");
         LLValue* arg = DtoBitCast(cond->getRVal(), fn->getFunctionType()->getParamType(0));
         gIR->CreateCallOrInvoke(fn, arg);
@@ -2146,7 +2204,7 @@ DValue* AssertExp::toElem(IRState* p)
         condty->ty == Tpointer && condty->nextOf()->ty == Tstruct &&
         (invdecl = ((TypeStruct*)condty->nextOf())->sym->inv) != NULL)
     {
-        Logger::print("calling struct invariant");
+        IF_LOG Logger::print("calling struct invariant");
         ((TypeStruct*)condty->nextOf())->sym->codegen(Type::sir);
         DFuncValue invfunc(invdecl, invdecl->ir.irFunc->func, cond->getRVal());
         DtoCallFunction(loc, NULL, &invfunc, NULL);
@@ -2161,7 +2219,7 @@ DValue* AssertExp::toElem(IRState* p)
 
 DValue* NotExp::toElem(IRState* p)
 {
-    Logger::print("NotExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("NotExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     DValue* u = e1->toElem(p);
@@ -2178,7 +2236,7 @@ DValue* NotExp::toElem(IRState* p)
 
 DValue* AndAndExp::toElem(IRState* p)
 {
-    Logger::print("AndAndExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("AndAndExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     DValue* u = e1->toElem(p);
@@ -2225,7 +2283,7 @@ DValue* AndAndExp::toElem(IRState* p)
 
 DValue* OrOrExp::toElem(IRState* p)
 {
-    Logger::print("OrOrExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("OrOrExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     DValue* u = e1->toElem(p);
@@ -2273,7 +2331,7 @@ DValue* OrOrExp::toElem(IRState* p)
 #define BinBitExp(X,Y) \
 DValue* X##Exp::toElem(IRState* p) \
 { \
-    Logger::print("%sExp::toElem: %s @ %s\n", #X, toChars(), type->toChars()); \
+    IF_LOG Logger::print("%sExp::toElem: %s @ %s\n", #X, toChars(), type->toChars()); \
     LOG_SCOPE; \
     DValue* u = e1->toElem(p); \
     DValue* v = e2->toElem(p); \
@@ -2290,7 +2348,7 @@ BinBitExp(Ushr,LShr);
 
 DValue* ShrExp::toElem(IRState* p)
 {
-    Logger::print("ShrExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("ShrExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
     DValue* u = e1->toElem(p);
     DValue* v = e2->toElem(p);
@@ -2306,7 +2364,7 @@ DValue* ShrExp::toElem(IRState* p)
 
 DValue* HaltExp::toElem(IRState* p)
 {
-    Logger::print("HaltExp::toElem: %s\n", toChars());
+    IF_LOG Logger::print("HaltExp::toElem: %s\n", toChars());
     LOG_SCOPE;
 
     // FIXME: DMD inserts a trap here... we probably should as well !?!
@@ -2333,7 +2391,7 @@ DValue* HaltExp::toElem(IRState* p)
 
 DValue* DelegateExp::toElem(IRState* p)
 {
-    Logger::print("DelegateExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("DelegateExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     if(func->isStatic())
@@ -2355,10 +2413,10 @@ DValue* DelegateExp::toElem(IRState* p)
         DValue* src = u;
         if (ClassDeclaration* cd = u->getType()->isClassHandle())
         {
-            Logger::println("context type is class handle");
+            IF_LOG Logger::println("context type is class handle");
             if (cd->isInterfaceDeclaration())
             {
-                Logger::println("context type is interface");
+                IF_LOG Logger::println("context type is interface");
                 src = DtoCastInterfaceToObject(u, ClassDeclaration::object->type);
             }
         }
@@ -2370,7 +2428,7 @@ DValue* DelegateExp::toElem(IRState* p)
 
     LLValue* castcontext = DtoBitCast(uval, int8ptrty);
 
-    Logger::println("func: '%s'", func->toPrettyChars());
+    IF_LOG Logger::println("func: '%s'", func->toPrettyChars());
 
     LLValue* castfptr;
 
@@ -2395,7 +2453,7 @@ DValue* DelegateExp::toElem(IRState* p)
 
 DValue* IdentityExp::toElem(IRState* p)
 {
-    Logger::print("IdentityExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("IdentityExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     DValue* l = e1->toElem(p);
@@ -2453,7 +2511,7 @@ DValue* IdentityExp::toElem(IRState* p)
 
 DValue* CommaExp::toElem(IRState* p)
 {
-    Logger::print("CommaExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("CommaExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     if (cachedLvalue)
@@ -2470,7 +2528,7 @@ DValue* CommaExp::toElem(IRState* p)
 
 void CommaExp::cacheLvalue(IRState* p)
 {
-    Logger::println("Caching l-value of %s", toChars());
+    IF_LOG Logger::println("Caching l-value of %s", toChars());
     LOG_SCOPE;
     cachedLvalue = toElem(p)->getLVal();
 }
@@ -2479,7 +2537,7 @@ void CommaExp::cacheLvalue(IRState* p)
 
 DValue* CondExp::toElem(IRState* p)
 {
-    Logger::print("CondExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("CondExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     Type* dtype = type->toBasetype();
@@ -2523,7 +2581,7 @@ DValue* CondExp::toElem(IRState* p)
 
 DValue* ComExp::toElem(IRState* p)
 {
-    Logger::print("ComExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("ComExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     DValue* u = e1->toElem(p);
@@ -2539,7 +2597,7 @@ DValue* ComExp::toElem(IRState* p)
 
 DValue* NegExp::toElem(IRState* p)
 {
-    Logger::print("NegExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("NegExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     DValue* l = e1->toElem(p);
@@ -2562,7 +2620,7 @@ DValue* NegExp::toElem(IRState* p)
 
 DValue* CatExp::toElem(IRState* p)
 {
-    Logger::print("CatExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("CatExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
 #if DMDV2
@@ -2588,7 +2646,7 @@ DValue* CatExp::toElem(IRState* p)
 
 DValue* CatAssignExp::toElem(IRState* p)
 {
-    Logger::print("CatAssignExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("CatAssignExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     DValue* l = e1->toElem(p);
@@ -2625,13 +2683,13 @@ DValue* CatAssignExp::toElem(IRState* p)
 
 DValue* FuncExp::toElem(IRState* p)
 {
-    Logger::print("FuncExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("FuncExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     assert(fd);
 
     if (fd->isNested()) Logger::println("nested");
-    Logger::println("kind = %s\n", fd->kind());
+    IF_LOG Logger::println("kind = %s\n", fd->kind());
 
     fd->codegen(Type::sir);
     assert(fd->ir.irFunc->func);
@@ -2682,7 +2740,7 @@ DValue* FuncExp::toElem(IRState* p)
 
 LLConstant* FuncExp::toConstElem(IRState* p)
 {
-    Logger::print("FuncExp::toConstElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("FuncExp::toConstElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     assert(fd);
@@ -2701,9 +2759,47 @@ LLConstant* FuncExp::toConstElem(IRState* p)
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
+// Returns the constant initializer for the elements of an array literal,
+// or NULL if not all of them are simple constants of type llElemType.
+static LLConstant* constArrayLiteralInit(IRState* p, Expressions* elements, LLType* llElemType)
+{
+    std::vector<LLConstant*> vals(elements->dim, NULL);
+    for (size_t i = 0; i < elements->dim; ++i)
+    {
+        Expression* expr = (Expression*)elements->data[i];
+        switch (expr->op)
+        {
+        case TOKint64:
+        case TOKfloat64:
+        case TOKcomplex80:
+        case TOKnull:
+        case TOKstring:
+            break;
+        case TOKarrayliteral:
+            // nested static arrays are stored inline, if all of their
+            // elements are constants too
+            if (expr->type->toBasetype()->ty == Tsarray && isaArray(llElemType))
+            {
+                vals[i] = constArrayLiteralInit(p, ((ArrayLiteralExp*)expr)->elements,
+                    isaArray(llElemType)->getElementType());
+                if (!vals[i] || vals[i]->getType() != llElemType)
+                    return NULL;
+                continue;
+            }
+            return NULL;
+        default:
+            return NULL;
+        }
+        vals[i] = expr->toConstElem(p);
+        if (vals[i]->getType() != llElemType)
+            return NULL;
+    }
+    return LLConstantArray::get(LLArrayType::get(llElemType, elements->dim), vals);
+}
+
 DValue* ArrayLiteralExp::toElem(IRState* p)
 {
-    Logger::print("ArrayLiteralExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("ArrayLiteralExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     // D types
@@ -2744,20 +2840,32 @@ DValue* ArrayLiteralExp::toElem(IRState* p)
     else
         dstMem = DtoRawAlloca(llStoType, 0, "arrayliteral");
 
-    // store elements
-    for (size_t i=0; i<len; ++i)
+    // if all elements are constants, copy them from a constant global
+    // instead of storing them one by one
+    if (LLConstant* init = constArrayLiteralInit(p, elements, llElemType))
     {
-        Expression* expr = (Expression*)elements->data[i];
-        LLValue* elemAddr;
-        if(dyn)
-            elemAddr = DtoGEPi1(dstMem, i, "tmp", p->scopebb());
-        else
-            elemAddr = DtoGEPi(dstMem,0,i,"tmp",p->scopebb());
+        LLGlobalVariable* global = new LLGlobalVariable(*gIR->module, init->getType(),
+            true, LLGlobalValue::InternalLinkage, init, ".arrayliteral");
+        DtoMemCpy(dstMem, global, DtoConstSize_t(getTypePaddedSize(llStoType)),
+            getABITypeAlign(llElemType));
+    }
+    else
+    {
+        // store elements
+        for (size_t i=0; i<len; ++i)
+        {
+            Expression* expr = (Expression*)elements->data[i];
+            LLValue* elemAddr;
+            if(dyn)
+                elemAddr = DtoGEPi1(dstMem, i, "tmp", p->scopebb());
+            else
+                elemAddr = DtoGEPi(dstMem,0,i,"tmp",p->scopebb());
 
-        // emulate assignment
-        DVarValue* vv = new DVarValue(expr->type, elemAddr);
-        DValue* e = expr->toElem(p);
-        DtoAssign(loc, vv, e);
+            // emulate assignment
+            DVarValue* vv = new DVarValue(expr->type, elemAddr);
+            DValue* e = expr->toElem(p);
+            DtoAssign(loc, vv, e);
+        }
     }
 
     // return storage directly ?
@@ -2772,7 +2880,7 @@ DValue* ArrayLiteralExp::toElem(IRState* p)
 
 LLConstant* ArrayLiteralExp::toConstElem(IRState* p)
 {
-    Logger::print("ArrayLiteralExp::toConstElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("ArrayLiteralExp::toConstElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     // extract D types
@@ -2835,7 +2943,7 @@ static LLValue* write_zeroes(LLValue* mem, unsigned start, unsigned end) {
 
 DValue* StructLiteralExp::toElem(IRState* p)
 {
-    Logger::print("StructLiteralExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("StructLiteralExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     // make sure the struct is fully resolved
@@ -2932,7 +3040,7 @@ DValue* StructLiteralExp::toElem(IRState* p)
 
 LLConstant* StructLiteralExp::toConstElem(IRState* p)
 {
-    Logger::print("StructLiteralExp::toConstElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("StructLiteralExp::toConstElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     // make sure the struct is resolved
@@ -2971,7 +3079,7 @@ LLConstant* StructLiteralExp::toConstElem(IRState* p)
 
 DValue* InExp::toElem(IRState* p)
 {
-    Logger::print("InExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("InExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     DValue* key = e1->toElem(p);
@@ -2982,7 +3090,7 @@ DValue* InExp::toElem(IRState* p)
 
 DValue* RemoveExp::toElem(IRState* p)
 {
-    Logger::print("RemoveExp::toElem: %s\n", toChars());
+    IF_LOG Logger::print("RemoveExp::toElem: %s\n", toChars());
     LOG_SCOPE;
 
     DValue* aa = e1->toElem(p);
@@ -2995,7 +3103,7 @@ DValue* RemoveExp::toElem(IRState* p)
 
 DValue* AssocArrayLiteralExp::toElem(IRState* p)
 {
-    Logger::print("AssocArrayLiteralExp::toElem: %s @ %s\n", toChars(), type->toChars());
+    IF_LOG Logger::print("AssocArrayLiteralExp::toElem: %s @ %s\n", toChars(), type->toChars());
     LOG_SCOPE;
 
     assert(keys);
@@ -3024,7 +3132,7 @@ DValue* AssocArrayLiteralExp::toElem(IRState* p)
         {
             Expression* ekey = keys->tdata()[i];
             Expression* eval = values->tdata()[i];
-            Logger::println("(%zu) aa[%s] = %s", i, ekey->toChars(), eval->toChars());
+            IF_LOG Logger::println("(%zu) aa[%s] = %s", i, ekey->toChars(), eval->toChars());
             unsigned errors = global.startGagging();
             LLConstant *ekeyConst = ekey->toConstElem(p);
             LLConstant *evalConst = eval->toConstElem(p);
@@ -3083,7 +3191,7 @@ LruntimeInit:
         Expression* ekey = (Expression*)keys->data[i];
         Expression* eval = (Expression*)values->data[i];
 
-        Logger::println("(%zu) aa[%s] = %s", i, ekey->toChars(), eval->toChars());
+        IF_LOG Logger::println("(%zu) aa[%s] = %s", i, ekey->toChars(), eval->toChars());
 
         // index
         DValue* key = ekey->toElem(p);
@@ -3139,7 +3247,7 @@ DValue* TypeExp::toElem(IRState *p)
 
 DValue* TupleExp::toElem(IRState *p)
 {
-    Logger::print("TupleExp::toElem() %s\n", toChars());
+    IF_LOG Logger::print("TupleExp::toElem() %s\n", toChars());
     std::vector<LLType*> types(exps->dim, NULL);
     for (size_t i = 0; i < exps->dim; i++)
     {
@@ -3168,7 +3276,7 @@ DValue* TupleExp::toElem(IRState *p)
 
 DValue* VectorExp::toElem(IRState* p)
 {
-    Logger::print("VectorExp::toElem() %s\n", toChars());
+    IF_LOG Logger::print("VectorExp::toElem() %s\n", toChars());
 
     TypeVector *type = (TypeVector*)to->toBasetype();
     assert(type->ty == Tvector);
@@ -219,7 +219,7 @@ LLType* DtoTypeNotVoid(Type* t)
 
 LLValue* DtoDelegateEquals(TOK op, LLValue* lhs, LLValue* rhs)
 {
-    Logger::println("Doing delegate equality");
+    IF_LOG Logger::println("Doing delegate equality");
     llvm::Value *b1, *b2;
     if (rhs == NULL)
     {
@@ -250,7 +250,7 @@ LLGlobalValue::LinkageTypes DtoLinkage(Dsymbol* sym)
     if (VarDeclaration* vd = sym->isVarDeclaration())
     {
         if (mustDefineSymbol(vd))
-            Logger::println("Variable %savailable externally: %s", (vd->availableExternally ? "" : "not "), vd->toChars());
+            IF_LOG Logger::println("Variable %savailable externally: %s", (vd->availableExternally ? "" : "not "), vd->toChars());
         // generated by inlining semantics run
         if (vd->availableExternally && mustDefineSymbol(sym))
             return llvm::GlobalValue::AvailableExternallyLinkage;
@@ -265,15 +265,16 @@ LLGlobalValue::LinkageTypes DtoLinkage(Dsymbol* sym)
     else if (FuncDeclaration* fdecl = sym->isFuncDeclaration())
     {
         if (mustDefineSymbol(fdecl))
-            Logger::println("Function %savailable externally: %s", (fdecl->availableExternally ? "" : "not "), fdecl->toChars());
+            IF_LOG Logger::println("Function %savailable externally: %s", (fdecl->availableExternally ? "" : "not "), fdecl->toChars());
         assert(fdecl->type->ty == Tfunction);
         TypeFunction* ft = (TypeFunction*)fdecl->type;
 
         // intrinsics are always external
         if (fdecl->llvmInternal == LLVMintrinsic)
             return llvm::GlobalValue::ExternalLinkage;
-        // generated by inlining semantics run
-        if (fdecl->availableExternally && mustDefineSymbol(sym))
+        // generated by inlining semantics run, or an inlining candidate
+        // from a template instance another module of this build emits
+        if ((fdecl->availableExternally || isTemplateInstanceOwnedElsewhere(fdecl)) && mustDefineSymbol(sym))
             return llvm::GlobalValue::AvailableExternallyLinkage;
         // array operations are always template linkage
         if (fdecl->isArrayOp == 1)
@@ -298,7 +299,7 @@ LLGlobalValue::LinkageTypes DtoLinkage(Dsymbol* sym)
     else if (ClassDeclaration* cd = sym->isClassDeclaration())
     {
         if (mustDefineSymbol(cd))
-            Logger::println("Class %savailable externally: %s", (cd->availableExternally ? "" : "not "), vd->toChars());
+            IF_LOG Logger::println("Class %savailable externally: %s", (cd->availableExternally ? "" : "not "), vd->toChars());
         // generated by inlining semantics run
         if (cd->availableExternally && mustDefineSymbol(sym))
             return llvm::GlobalValue::AvailableExternallyLinkage;
@@ -1000,7 +1001,7 @@ LLValue* DtoAggrPaint(LLValue* aggr, LLType* as)
 
 LLValue* DtoAggrPairSwap(LLValue* aggr)
 {
-    Logger::println("swapping aggr pair");
+    IF_LOG Logger::println("swapping aggr pair");
     LLValue* r = gIR->ir->CreateExtractValue(aggr, 0);
     LLValue* i = gIR->ir->CreateExtractValue(aggr, 1);
     return DtoAggrPair(i, r, "swapped");
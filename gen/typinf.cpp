@@ -305,7 +305,7 @@ void DtoResolveTypeInfo(TypeInfoDeclaration* tid)
     if (tid->ir.resolved) return;
     tid->ir.resolved = true;
 
-    Logger::println("DtoResolveTypeInfo(%s)", tid->toChars());
+    IF_LOG Logger::println("DtoResolveTypeInfo(%s)", tid->toChars());
     LOG_SCOPE;
 
     std::string mangle(tid->mangle());
@@ -326,7 +326,6 @@ void DtoResolveTypeInfo(TypeInfoDeclaration* tid)
 
     tid->ir.irGlobal = irg;
 
-#if USE_METADATA
     // don't do this for void or llvm will crash
     if (tid->tinfo->ty != Tvoid) {
         // Add some metadata for use by optimization passes.
@@ -341,12 +340,11 @@ void DtoResolveTypeInfo(TypeInfoDeclaration* tid)
                 mdVals[TD_Confirm] = llvm::cast<MDNodeField>(irg->value);
             mdVals[TD_Type] = llvm::UndefValue::get(DtoType(tid->tinfo));
             // Construct the metadata
-            llvm::MetadataBase* metadata = llvm::MDNode::get(gIR->context(), mdVals, TD_NumFields);
+            llvm::MDNode* metadata = llvm::MDNode::get(gIR->context(), llvm::makeArrayRef(mdVals, TD_NumFields));
             // Insert it into the module
-            llvm::NamedMDNode::Create(gIR->context(), metaname, &metadata, 1, gIR->module);
+            gIR->module->getOrInsertNamedMetadata(metaname)->addOperand(metadata);
         }
     }
-#endif // USE_METADATA
 
     DtoDeclareTypeInfo(tid);
 }
@@ -358,14 +356,14 @@ void DtoDeclareTypeInfo(TypeInfoDeclaration* tid)
     if (tid->ir.declared) return;
     tid->ir.declared = true;
 
-    Logger::println("DtoDeclareTypeInfo(%s)", tid->toChars());
+    IF_LOG Logger::println("DtoDeclareTypeInfo(%s)", tid->toChars());
     LOG_SCOPE;
 
     if (Logger::enabled())
     {
         std::string mangled(tid->mangle());
-        Logger::println("type = '%s'", tid->tinfo->toChars());
-        Logger::println("typeinfo mangle: %s", mangled.c_str());
+        IF_LOG Logger::println("type = '%s'", tid->tinfo->toChars());
+        IF_LOG Logger::println("typeinfo mangle: %s", mangled.c_str());
     }
 
     IrGlobal* irg = tid->ir.irGlobal;
@@ -386,7 +384,7 @@ void DtoDeclareTypeInfo(TypeInfoDeclaration* tid)
 
 void TypeInfoDeclaration::llvmDefine()
 {
-    Logger::println("TypeInfoDeclaration::llvmDefine() %s", toChars());
+    IF_LOG Logger::println("TypeInfoDeclaration::llvmDefine() %s", toChars());
     LOG_SCOPE;
 
     RTTIBuilder b(Type::typeinfo);
@@ -397,7 +395,7 @@ void TypeInfoDeclaration::llvmDefine()
 
 void TypeInfoTypedefDeclaration::llvmDefine()
 {
-    Logger::println("TypeInfoTypedefDeclaration::llvmDefine() %s", toChars());
+    IF_LOG Logger::println("TypeInfoTypedefDeclaration::llvmDefine() %s", toChars());
     LOG_SCOPE;
 
     RTTIBuilder b(Type::typeinfotypedef);
@@ -435,7 +433,7 @@ void TypeInfoTypedefDeclaration::llvmDefine()
 
 void TypeInfoEnumDeclaration::llvmDefine()
 {
-    Logger::println("TypeInfoEnumDeclaration::llvmDefine() %s", toChars());
+    IF_LOG Logger::println("TypeInfoEnumDeclaration::llvmDefine() %s", toChars());
     LOG_SCOPE;
 
     RTTIBuilder b(Type::typeinfoenum);
@@ -477,7 +475,7 @@ void TypeInfoEnumDeclaration::llvmDefine()
 
 void TypeInfoPointerDeclaration::llvmDefine()
 {
-    Logger::println("TypeInfoPointerDeclaration::llvmDefine() %s", toChars());
+    IF_LOG Logger::println("TypeInfoPointerDeclaration::llvmDefine() %s", toChars());
     LOG_SCOPE;
 
     RTTIBuilder b(Type::typeinfopointer);
@@ -491,7 +489,7 @@ void TypeInfoPointerDeclaration::llvmDefine()
 
 void TypeInfoArrayDeclaration::llvmDefine()
 {
-    Logger::println("TypeInfoArrayDeclaration::llvmDefine() %s", toChars());
+    IF_LOG Logger::println("TypeInfoArrayDeclaration::llvmDefine() %s", toChars());
     LOG_SCOPE;
 
     RTTIBuilder b(Type::typeinfoarray);
@@ -505,7 +503,7 @@ void TypeInfoArrayDeclaration::llvmDefine()
 
 void TypeInfoStaticArrayDeclaration::llvmDefine()
 {
-    Logger::println("TypeInfoStaticArrayDeclaration::llvmDefine() %s", toChars());
+    IF_LOG Logger::println("TypeInfoStaticArrayDeclaration::llvmDefine() %s", toChars());
     LOG_SCOPE;
 
     assert(tinfo->ty == Tsarray);
@@ -527,7 +525,7 @@ void TypeInfoStaticArrayDeclaration::llvmDefine()
 
 void TypeInfoAssociativeArrayDeclaration::llvmDefine()
 {
-    Logger::println("TypeInfoAssociativeArrayDeclaration::llvmDefine() %s", toChars());
+    IF_LOG Logger::println("TypeInfoAssociativeArrayDeclaration::llvmDefine() %s", toChars());
     LOG_SCOPE;
 
     assert(tinfo->ty == Taarray);
@@ -554,7 +552,7 @@ void TypeInfoAssociativeArrayDeclaration::llvmDefine()
 
 void TypeInfoFunctionDeclaration::llvmDefine()
 {
-    Logger::println("TypeInfoFunctionDeclaration::llvmDefine() %s", toChars());
+    IF_LOG Logger::println("TypeInfoFunctionDeclaration::llvmDefine() %s", toChars());
     LOG_SCOPE;
 
     RTTIBuilder b(Type::typeinfofunction);
@@ -570,7 +568,7 @@ void TypeInfoFunctionDeclaration::llvmDefine()
 
 void TypeInfoDelegateDeclaration::llvmDefine()
 {
-    Logger::println("TypeInfoDelegateDeclaration::llvmDefine() %s", toChars());
+    IF_LOG Logger::println("TypeInfoDelegateDeclaration::llvmDefine() %s", toChars());
     LOG_SCOPE;
 
     assert(tinfo->ty == Tdelegate);
@@ -604,7 +602,7 @@ static FuncDeclaration* find_method_overload(AggregateDeclaration* ad, Identifie
 
 void TypeInfoStructDeclaration::llvmDefine()
 {
-    Logger::println("TypeInfoStructDeclaration::llvmDefine() %s", toChars());
+    IF_LOG Logger::println("TypeInfoStructDeclaration::llvmDefine() %s", toChars());
     LOG_SCOPE;
 
     // make sure struct is resolved
@@ -768,7 +766,7 @@ void TypeInfoClassDeclaration::llvmDefine()
 #if DMDV2
     assert(0);
 #endif
-    Logger::println("TypeInfoClassDeclaration::llvmDefine() %s", toChars());
+    IF_LOG Logger::println("TypeInfoClassDeclaration::llvmDefine() %s", toChars());
     LOG_SCOPE;
 
     // make sure class is resolved
@@ -789,7 +787,7 @@ void TypeInfoClassDeclaration::llvmDefine()
 
 void TypeInfoInterfaceDeclaration::llvmDefine()
 {
-    Logger::println("TypeInfoInterfaceDeclaration::llvmDefine() %s", toChars());
+    IF_LOG Logger::println("TypeInfoInterfaceDeclaration::llvmDefine() %s", toChars());
     LOG_SCOPE;
 
     // make sure interface is resolved
@@ -810,7 +808,7 @@ void TypeInfoInterfaceDeclaration::llvmDefine()
 
 void TypeInfoTupleDeclaration::llvmDefine()
 {
-    Logger::println("TypeInfoTupleDeclaration::llvmDefine() %s", toChars());
+    IF_LOG Logger::println("TypeInfoTupleDeclaration::llvmDefine() %s", toChars());
     LOG_SCOPE;
 
     // create elements array
@@ -848,7 +846,7 @@ void TypeInfoTupleDeclaration::llvmDefine()
 
 void TypeInfoConstDeclaration::llvmDefine()
 {
-    Logger::println("TypeInfoConstDeclaration::llvmDefine() %s", toChars());
+    IF_LOG Logger::println("TypeInfoConstDeclaration::llvmDefine() %s", toChars());
     LOG_SCOPE;
 
     RTTIBuilder b(Type::typeinfoconst);
@@ -862,7 +860,7 @@ void TypeInfoConstDeclaration::llvmDefine()
 
 void TypeInfoInvariantDeclaration::llvmDefine()
 {
-    Logger::println("TypeInfoInvariantDeclaration::llvmDefine() %s", toChars());
+    IF_LOG Logger::println("TypeInfoInvariantDeclaration::llvmDefine() %s", toChars());
     LOG_SCOPE;
 
     RTTIBuilder b(Type::typeinfoinvariant);
@@ -876,7 +874,7 @@ void TypeInfoInvariantDeclaration::llvmDefine()
 
 void TypeInfoSharedDeclaration::llvmDefine()
 {
-    Logger::println("TypeInfoSharedDeclaration::llvmDefine() %s", toChars());
+    IF_LOG Logger::println("TypeInfoSharedDeclaration::llvmDefine() %s", toChars());
     LOG_SCOPE;
 
     RTTIBuilder b(Type::typeinfoshared);
@@ -890,7 +888,7 @@ void TypeInfoSharedDeclaration::llvmDefine()
 
 void TypeInfoWildDeclaration::llvmDefine()
 {
-    Logger::println("TypeInfoWildDeclaration::llvmDefine() %s", toChars());
+    IF_LOG Logger::println("TypeInfoWildDeclaration::llvmDefine() %s", toChars());
     LOG_SCOPE;
 
     RTTIBuilder b(Type::typeinfowild);
@@ -906,7 +904,7 @@ void TypeInfoWildDeclaration::llvmDefine()
 
 void TypeInfoVectorDeclaration::llvmDefine()
 {
-    Logger::println("TypeInfoVectorDeclaration::llvmDefine() %s", toChars());
+    IF_LOG Logger::println("TypeInfoVectorDeclaration::llvmDefine() %s", toChars());
     LOG_SCOPE;
 
     assert(tinfo->ty == Tvector);
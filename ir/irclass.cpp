@@ -73,14 +73,17 @@ LLGlobalVariable * IrStruct::getClassInfoSymbol()
     classInfo = new llvm::GlobalVariable(
                 *gIR->module, tc->getType(), false, _linkage, NULL, initname);
 
-#if USE_METADATA
     // Generate some metadata on this ClassInfo if it's for a class.
+    std::string metaname = CD_PREFIX + initname;
     ClassDeclaration* classdecl = aggrdecl->isClassDeclaration();
-    if (classdecl && !aggrdecl->isInterfaceDeclaration()) {
+    if (classdecl && !aggrdecl->isInterfaceDeclaration() &&
+        !gIR->module->getNamedMetadata(metaname)) {
         // Gather information
         LLType* type = DtoType(aggrdecl->type);
         LLType* bodyType = llvm::cast<LLPointerType>(type)->getElementType();
-        bool hasDestructor = (classdecl->dtor != NULL);
+        bool hasDestructor = false;
+        for (ClassDeclaration* cd = classdecl; cd; cd = cd->baseClass)
+            hasDestructor |= (cd->dtor != NULL);
         bool hasCustomDelete = (classdecl->aggDelete != NULL);
         // Construct the fields
         MDNodeField* mdVals[CD_NumFields];
@@ -88,12 +91,10 @@ LLGlobalVariable * IrStruct::getClassInfoSymbol()
         mdVals[CD_Finalize] = LLConstantInt::get(LLType::getInt1Ty(gIR->context()), hasDestructor);
         mdVals[CD_CustomDelete] = LLConstantInt::get(LLType::getInt1Ty(gIR->context()), hasCustomDelete);
         // Construct the metadata
-        llvm::MetadataBase* metadata = llvm::MDNode::get(gIR->context(), mdVals, CD_NumFields);
+        llvm::MDNode* metadata = llvm::MDNode::get(gIR->context(), llvm::makeArrayRef(mdVals, CD_NumFields));
         // Insert it into the module
-        std::string metaname = CD_PREFIX + initname;
-        llvm::NamedMDNode::Create(gIR->context(), metaname, &metadata, 1, gIR->module);
+        gIR->module->getOrInsertNamedMetadata(metaname)->addOperand(metadata);
     }
-#endif // USE_METADATA
 
     return classInfo;
 }
@@ -218,7 +219,7 @@ LLConstant * IrStruct::getVtblInit()
     {
         if (constVtbl->getOperand(i)->getType() != vtblTy->getContainedType(i))
         {
-            Logger::cout() << "type mismatch for entry # " << i << " in vtbl initializer" << std::endl;
+            IF_LOG Logger::cout() << "type mismatch for entry # " << i << " in vtbl initializer" << std::endl;
 
             constVtbl->getOperand(i)->dump();
             vtblTy->getContainedType(i)->dump();
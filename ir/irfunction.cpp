@@ -33,7 +33,7 @@ llvm::Value* IrFuncTy::putRet(Type* dty, DValue* val)
 {
     assert(!arg_sret);
     if (ret->rewrite) {
-        Logger::println("Rewrite: putRet");
+        IF_LOG Logger::println("Rewrite: putRet");
         LOG_SCOPE
         return ret->rewrite->put(dty, val);
     }
@@ -44,7 +44,7 @@ llvm::Value* IrFuncTy::getRet(Type* dty, DValue* val)
 {
     assert(!arg_sret);
     if (ret->rewrite) {
-        Logger::println("Rewrite: getRet");
+        IF_LOG Logger::println("Rewrite: getRet");
         LOG_SCOPE
         return ret->rewrite->get(dty, val);
     }
@@ -55,7 +55,7 @@ llvm::Value* IrFuncTy::putParam(Type* dty, int idx, DValue* val)
 {
     assert(idx >= 0 && idx < args.size() && "invalid putParam");
     if (args[idx]->rewrite) {
-        Logger::println("Rewrite: putParam");
+        IF_LOG Logger::println("Rewrite: putParam");
         LOG_SCOPE
         return args[idx]->rewrite->put(dty, val);
     }
@@ -66,7 +66,7 @@ llvm::Value* IrFuncTy::getParam(Type* dty, int idx, DValue* val)
 {
     assert(idx >= 0 && idx < args.size() && "invalid getParam");
     if (args[idx]->rewrite) {
-        Logger::println("Rewrite: getParam (get)");
+        IF_LOG Logger::println("Rewrite: getParam (get)");
         LOG_SCOPE
         return args[idx]->rewrite->get(dty, val);
     }
@@ -79,7 +79,7 @@ void IrFuncTy::getParam(Type* dty, int idx, DValue* val, llvm::Value* lval)
 
     if (args[idx]->rewrite)
     {
-        Logger::println("Rewrite: getParam (getL)");
+        IF_LOG Logger::println("Rewrite: getParam (getL)");
         LOG_SCOPE
         args[idx]->rewrite->getL(dty, val, lval);
         return;
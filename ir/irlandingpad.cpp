@@ -198,7 +198,7 @@ LLValue* IRLandingPad::getExceptionStorage()
 {
     if(!catch_var)
     {
-        Logger::println("Making new catch var");
+        IF_LOG Logger::println("Making new catch var");
         catch_var = DtoAlloca(ClassDeclaration::object->type, "catchvar");
     }
     return catch_var;